@@ -1,35 +1,40 @@
 #include "analyzing.hpp"
 #include "dynamic_arrays.hpp"
 #include "datetime.hpp"
+#include "filtering.hpp"
+#include "spilling.hpp"
+#include "merging.hpp"
+#include "batching.hpp"
+#include "normalizing.hpp"
+#include "swar.hpp"
 
 #include <iostream>
 #include <fstream>
 #include <filesystem>
 #include <cstring>
 #include <sstream>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
 
 void UpdateStatistics(StatsArray& statistics, const char* request) {
-    for (size_t i = 0; i < statistics.size; ++i) {
-        if (std::strcmp(statistics.data[i].request, request) == 0) {
-            ++statistics.data[i].frequency;
-            return;
-        }
-    }
-
-    RequestStatistic stat;
-    stat.frequency = 1;
-    stat.request = new char[std::strlen(request) + 1];
-    std::strcpy(stat.request, request);
-
-    AddElement(statistics, stat);
+    ++FindOrAddRequest(statistics, request).frequency;
 }
 
-void PrintStats(const StatsArray& stats, int32_t amount) {
+void PrintStats(const StatsArray& stats, int32_t amount, const SampleAccumulator* sample) {
     std::cout << "\n[5XX requests statistics]:\n";
 
     for (size_t i = 0; i < amount && i < stats.size; ++i) {
-        std::cout << "* " << stats.data[i].request << " - " 
-                  << stats.data[i].frequency << " request" << (stats.data[i].frequency == 1 ? "" : "s") << '\n';
+        std::cout << "* " << stats.data[i].request << " - ";
+
+        if (sample != nullptr) {
+            Estimate frequency = EstimateCount(*sample, stats.data[i].frequency);
+            std::cout << "~" << std::llround(frequency.value) << " +- " << std::llround(frequency.margin) << " requests\n";
+            continue;
+        }
+
+        std::cout << stats.data[i].frequency << " request" << (stats.data[i].frequency == 1 ? "" : "s") << '\n';
     }
 
     if (stats.size == 0) {
@@ -49,267 +54,571 @@ void PrintWindow(uint64_t lower_timestamp, uint64_t higher_timestamp, uint32_t a
     std::cout << amount_of_requests << " request" << (amount_of_requests == 1 ? ")" : "s)");
 }
 
-std::optional<const char*> AnalyzeLog(const Parameters& parameters) {
-    std::ifstream input_file(parameters.logs_filename);
-    if (input_file.fail()) {
-        return "Unable to read the input file";
-    }
+void PrintWindowResult(const char* title, const WindowResult& result) {
+    char higher_time[27];
+    char lower_time[27];
 
-    std::ofstream output_file;
-    if (parameters.output_path != nullptr) {
-        output_file = std::ofstream(parameters.output_path);
-        if (output_file.fail()) {
-            return "Unable to open the output file";
-        }
+    TimestampToDateTimeString(result.higher_timestamp, higher_time);
+    TimestampToDateTimeString(result.lower_timestamp, lower_time);
+
+    std::cout << "\n\n[" << title << "]:\n";
+
+    if (result.amount_of_server_errors == 0) {
+        std::cout << "No 5XX requests found";
+        return;
     }
 
-    std::ofstream invalid_lines_output_file;
-    if (parameters.invalid_lines_output_path != nullptr) {
-        invalid_lines_output_file = std::ofstream(parameters.invalid_lines_output_path);
-        if (output_file.fail()) {
-            return "Unable to open the invalid lines output file";
-        }
+    std::cout << '[' << lower_time << "] - [" << higher_time << "] (" << result.amount_of_server_errors << " of "
+              << result.amount_of_requests << " request" << (result.amount_of_requests == 1 ? "" : "s") << " with the code 5XX, "
+              << std::fixed << std::setprecision(1) << GetErrorRate(result) * 100 << "%)" << std::defaultfloat;
+}
+
+void PrintErrorWindows(const WindowState& window) {
+    PrintWindowResult("Window with most 5XX requests", window.max_server_errors_window);
+    PrintWindowResult("Window with highest 5XX rate", window.max_error_rate_window);
+}
+
+void PrintAlerts(const WindowState& window) {
+    // the earlier sections leave their own precision in the stream
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+
+    std::cout << std::fixed << std::setprecision(1) << "\n\n[Alerts]:";
+
+    for (size_t i = 0; i < window.alerts_amount; ++i) {
+        char higher_time[27];
+        char lower_time[27];
+
+        TimestampToDateTimeString(window.alerts[i].higher_timestamp, higher_time);
+        TimestampToDateTimeString(window.alerts[i].lower_timestamp, lower_time);
+
+        std::cout << "\n* [" << lower_time << "] - [" << higher_time << "] (up to "
+                  << window.alerts[i].max_error_rate * 100 << "% of requests with the code 5XX)";
     }
 
-    StatsArray error_logs_stats;
+    if (window.alerts_amount == 0) {
+        std::cout << "\nThe 5XX rate has not exceeded " << window.alert_rate * 100 << "% in any window";
+    }
 
-    // calculation of the "window"
-    uint64_t lower_timestamp = 0;
-    uint64_t higher_timestamp;
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
 
-    uint32_t max_amount_of_requests = 0;
-    uint32_t current_amount_of_requests = 0;
+void PrintTopWindows(const SecondCounts& counts, uint32_t length, int32_t amount) {
+    WindowResult* windows;
+    size_t windows_amount = FindTopWindows(counts, length, amount, windows);
 
-    uint64_t result_lower_timestamp = 0;
-    uint64_t result_higher_timestamp = 0;
+    std::cout << "\n\n[Top windows]:";
 
-    uint64_t last_timestamp;
+    for (size_t i = 0; i < windows_amount; ++i) {
+        char higher_time[27];
+        char lower_time[27];
 
-    uint32_t* amount_of_requests_in_second = new uint32_t[parameters.window];
-    std::fill(amount_of_requests_in_second, amount_of_requests_in_second + parameters.window, 0);
+        TimestampToDateTimeString(windows[i].higher_timestamp, higher_time);
+        TimestampToDateTimeString(windows[i].lower_timestamp, lower_time);
 
-    uint32_t array_offset = 0;
+        std::cout << '\n' << i + 1 << ". [" << lower_time << "] - [" << higher_time << "] ("
+                  << windows[i].amount_of_requests << " request" << (windows[i].amount_of_requests == 1 ? ")" : "s)");
+    }
 
-    char* line_buffer = new char[kLineBufferSize];
+    if (windows_amount == 0) {
+        std::cout << "\nNo requests found";
+    }
 
-    LogEntry entry;
+    if (windows != nullptr) {
+        delete[] windows;
+    }
+}
 
-    uint64_t lines_analyzed = 0;
-    uint64_t invalid_lines_amount = 0;
-    uint64_t server_error_lines_amount = 0;
-    uint64_t too_long_lines_amount = 0;
+void PrintNodeThroughput(const AnalysisContext& context) {
+    std::cout << "\n[NUMA nodes]:\n";
 
-    while (input_file.good()) {
-        input_file.getline(line_buffer, kLineBufferSize);
-        ++lines_analyzed;
+    for (size_t i = 0; i < context.nodes_amount; ++i) {
+        const NodeThroughput& throughput = context.node_throughput[i];
+        double megabytes = static_cast<double>(throughput.bytes_read) / kBytesInMegabyte;
 
-        if (input_file.fail()) {
-            if (input_file.eof()) {
-                --lines_analyzed;
-                break;
-            }
+        std::cout << "* Node " << throughput.node_id << ": " << throughput.files_amount << " file"
+                  << (throughput.files_amount == 1 ? "" : "s") << ", " << throughput.lines_amount << " lines, "
+                  << std::fixed << std::setprecision(1) << megabytes << " MB in " << std::setprecision(3)
+                  << throughput.busy_seconds << " s";
 
-            input_file.clear();
-            input_file.ignore(UINT64_MAX, '\n');
-            ++too_long_lines_amount;
-            continue;
+        if (throughput.busy_seconds > 0) {
+            std::cout << " (" << std::setprecision(1) << megabytes / throughput.busy_seconds << " MB/s)";
         }
 
-        if (!ParseLogEntry(entry, line_buffer)) {
-            if (parameters.invalid_lines_output_path != nullptr) {
-                invalid_lines_output_file << line_buffer << std::endl;
-            }
+        std::cout << std::defaultfloat << '\n';
+    }
+}
 
-            ++invalid_lines_amount;
-            continue;
-        }
+void PrintSampleEstimates(const AnalysisContext& context) {
+    const SampleAccumulator& sample = context.sample;
 
-        if (parameters.from_time > entry.timestamp) {
-            continue;
-        } else if (parameters.to_time != 0 && parameters.to_time < entry.timestamp) {
-            break;
-        }
+    Estimate lines = EstimateTotal(sample, sample.lines_sum, sample.lines_squares_sum);
+    Estimate errors = EstimateTotal(sample, sample.errors_sum, sample.errors_squares_sum);
 
-        if (parameters.window != 0) {
-            if (lower_timestamp == 0) {
-                lower_timestamp = entry.timestamp;
-                higher_timestamp = lower_timestamp + parameters.window - 1;
-            }
+    std::cout << "\n[Sampling]:\n";
+    std::cout << "Sampled " << sample.sampled_blocks_amount << " of " << sample.blocks_amount << " blocks, "
+              << "estimates are given with 95% confidence intervals\n";
+    std::cout << "* Lines: ~" << std::llround(lines.value) << " +- " << std::llround(lines.margin) << '\n';
+    std::cout << "* 5XX lines: ~" << std::llround(errors.value) << " +- " << std::llround(errors.margin) << '\n';
+}
 
-            if (entry.timestamp >= lower_timestamp && entry.timestamp <= higher_timestamp) {
-                ++amount_of_requests_in_second[(array_offset + entry.timestamp - lower_timestamp) % parameters.window];
-            } else {
-                if (current_amount_of_requests > max_amount_of_requests) {
-                    max_amount_of_requests = current_amount_of_requests;
-                    result_higher_timestamp = higher_timestamp;
-                    result_lower_timestamp = lower_timestamp;
-                }
-                
-                higher_timestamp = entry.timestamp;
-
-                while (lower_timestamp + parameters.window <= higher_timestamp) {
-                    current_amount_of_requests -= amount_of_requests_in_second[array_offset % parameters.window];
-                    amount_of_requests_in_second[array_offset % parameters.window] = 0;
-
-                    ++array_offset;
-                    ++lower_timestamp;
-                }
-
-                ++amount_of_requests_in_second[(array_offset + parameters.window - 1) % parameters.window];
-            }
+bool IsLazyParsingPossible(const Parameters& parameters) {
+    // only 5XX lines reach the outputs unless some option needs the timestamps or the validation of every line,
+    // the sampling estimates are extrapolated from all the matched lines
+    return parameters.window == 0 && parameters.from_time == 0 && parameters.to_time == 0
+        && parameters.invalid_lines_output_path == nullptr && parameters.histogram == 0 && parameters.sample_rate == 1.0;
+}
 
-            ++current_amount_of_requests;
-        }
+std::optional<char> ReadStatusClassFromTail(const char* line, size_t length) {
+    // format of the tail: "<request>" <status> <bytes_sent>
+    const char* position = line + length;
 
-        if (entry.status.data[0] == '5') {
-            ++server_error_lines_amount;
-        }
+    if (position == line) {
+        return std::nullopt;
+    }
 
-        if (parameters.output_path != nullptr && parameters.stats > 0 && entry.status.data[0] == '5') {
-            UpdateStatistics(error_logs_stats, entry.request.data);
+    if (position[-1] == '-') {
+        --position;
+    } else {
+        while (position != line && position[-1] >= '0' && position[-1] <= '9') {
+            --position;
         }
+    }
 
-        if (parameters.output_path != nullptr && entry.status.data[0] == '5') {
-            output_file << line_buffer << std::endl;
-            if (parameters.need_print) {
-                std::cout << line_buffer << std::endl;
-            }
+    if (position == line + length || position - line < 6) {
+        return std::nullopt;
+    }
+
+    const char* status = position - 4;
+
+    if (position[-1] != ' ' || status[-1] != ' ' || status[-2] != '"'
+     || status[0] < '0' || status[0] > '9' || status[1] < '0' || status[1] > '9' || status[2] < '0' || status[2] > '9')
+    {
+        return std::nullopt;
+    }
+
+    return status[0];
+}
+
+LineClass ClassifyLine(const LogFilter& filter, LogEntry& entry, const char* line, bool is_lazy) {
+    if (is_lazy) {
+        std::optional<char> status_class = ReadStatusClassFromTail(line, std::strlen(line));
+
+        // lines with a broken tail go through the full parsing to be reported as invalid
+        if (status_class.has_value() && status_class.value() != '5') {
+            return LineClass::kSkipped;
         }
+    }
+
+    bool is_split = SplitLogEntry(entry, line);
+
+    // rejected lines are dropped before the timestamp is parsed, which is the most expensive part
+    if (is_split && !filter.is_empty && !MatchesFilter(filter, 
+        std::string_view(entry.remote_addr.data, entry.remote_addr.size),
+        std::string_view(entry.request.data, entry.request.size),
+        std::string_view(entry.status.data, entry.status.size)))
+    {
+        return LineClass::kFiltered;
+    }
 
-        last_timestamp = entry.timestamp;
+    if (!is_split || !ParseLogEntryTimestamp(entry)) {
+        return LineClass::kInvalid;
     }
 
-    std::cout << "Analyzed " << lines_analyzed << " lines, " << server_error_lines_amount << " were with the code 5XX, "
-        << invalid_lines_amount << " were invalid, " << too_long_lines_amount << " were ignored (too long)." << std::endl;
+    return LineClass::kValid;
+}
+
+bool IsBeyondTimeRange(const Parameters& parameters, uint64_t timestamp) {
+    // with a reorder buffer an entry up to max_skew seconds later than --to may still be followed by matching ones
+    return parameters.to_time != 0 && parameters.to_time + parameters.max_skew < timestamp;
+}
+
+bool IsInTimeRange(const Parameters& parameters, uint64_t timestamp) {
+    return parameters.from_time <= timestamp && (parameters.to_time == 0 || timestamp <= parameters.to_time);
+}
+
+bool AnalyzeLine(AnalysisContext& context, const char* line) {
+    LogEntry& entry = context.entry;
+
+    LineClass line_class = ClassifyLine(context.filter, entry, line, context.is_lazy);
+
+    if (line_class == LineClass::kSkipped) {
+        ++context.unparsed_lines_amount;
+        return true;
+    } else if (line_class == LineClass::kFiltered) {
+        ++context.filtered_lines_amount;
+        return true;
+    } else if (line_class == LineClass::kInvalid) {
+        if (context.parameters->invalid_lines_output_path != nullptr) {
+            WriteLine(context.invalid_lines_output_file, line);
+        }
 
-    if (entry.remote_addr.data != nullptr) {
-        delete[] entry.remote_addr.data;
+        ++context.invalid_lines_amount;
+        return true;
     }
 
-    if (entry.request.data != nullptr) {
-        delete[] entry.request.data;
+    const NormalizationRules& rules = context.parameters->normalization_rules;
+
+    if (entry.status.data[0] == '5' && IsNormalizationEnabled(rules)) {
+        NormalizeRequest(entry.request, rules);
     }
 
-    if (entry.status.data != nullptr) {
-        delete[] entry.status.data;
+    return AnalyzeEntry(context, entry.timestamp, entry.status.data[0] == '5', entry.bytes_sent, entry.request.data, line);
+}
+
+bool AnalyzeEntry(AnalysisContext& context, uint64_t timestamp, bool is_server_error, int64_t bytes_sent,
+                  const char* request, const char* line) {
+    const Parameters& parameters = *context.parameters;
+
+    if (IsBeyondTimeRange(parameters, timestamp)) {
+        return false;
+    } else if (!IsInTimeRange(parameters, timestamp)) {
+        return true;
     }
 
-    delete[] line_buffer;
-    delete[] amount_of_requests_in_second;
+    ++context.matched_lines_amount;
+
+    CountEntry(context, timestamp, is_server_error, bytes_sent);
 
-    if (current_amount_of_requests > max_amount_of_requests) {
-        max_amount_of_requests = current_amount_of_requests;
-        result_higher_timestamp = higher_timestamp;
-        result_lower_timestamp = lower_timestamp;
+    if (is_server_error) {
+        ++context.server_error_lines_amount;
+
+        if (!CountServerError(context, request, line)) {
+            return false;
+        }
     }
 
-    if (result_higher_timestamp > last_timestamp) {
-        result_higher_timestamp = last_timestamp;
+    context.last_timestamp = std::max(context.last_timestamp, timestamp);
+
+    return true;
+}
+
+void UpdateWindowEntry(AnalysisContext& context, uint64_t timestamp, bool is_server_error) {
+    if (context.parameters->max_skew == 0) {
+        UpdateWindow(context.window, timestamp, is_server_error);
+        return;
     }
 
-    if (parameters.output_path != nullptr && parameters.stats > 0) {
-        SortByFrequency(error_logs_stats);
-        PrintStats(error_logs_stats, parameters.stats);
+    PushTimestamp(context.reorder_buffer, timestamp, is_server_error);
+
+    uint64_t ready_timestamp;
+    bool is_ready_server_error;
+
+    while (PopReadyTimestamp(context.reorder_buffer, ready_timestamp, is_ready_server_error)) {
+        UpdateWindow(context.window, ready_timestamp, is_ready_server_error);
     }
+}
 
-    if (error_logs_stats.data != nullptr) {
-        delete[] error_logs_stats.data;
+void CountEntry(AnalysisContext& context, uint64_t timestamp, bool is_server_error, int64_t bytes_sent) {
+    const Parameters& parameters = *context.parameters;
+
+    if (parameters.window != 0) {
+        UpdateWindowEntry(context, timestamp, is_server_error);
     }
 
-    if (parameters.window > 0) {
-        PrintWindow(result_lower_timestamp, result_higher_timestamp, max_amount_of_requests);
+    // the counts do not depend on the order of the entries, so they bypass the reorder buffer
+    if (parameters.window_top != 0) {
+        AddToSecondCounts(context.second_counts, timestamp);
     }
 
-    return std::nullopt;
+    if (parameters.histogram != 0) {
+        AddToHistogram(context.histogram, timestamp, is_server_error, bytes_sent);
+    }
 }
 
-std::optional<size_t> FindSubstring(const char* haystack, const char* needle, size_t start_from = 0) {
-    const char* search_result = std::strstr(haystack + start_from, needle);
-    if (search_result == nullptr) {
-        return std::nullopt;
+bool CountServerError(AnalysisContext& context, const char* request, const char* line) {
+    const Parameters& parameters = *context.parameters;
+
+    if (parameters.output_path != nullptr && parameters.stats > 0) {
+        UpdateStatistics(context.error_logs_stats, request);
+
+        if (parameters.memory_limit != 0 && GetMemoryUsage(context.error_logs_stats) > parameters.memory_limit * kBytesInMegabyte) {
+            if (!SpillStatistics(context.spill_runs, context.error_logs_stats)) {
+                context.error = "Unable to write a temporary file";
+                return false;
+            }
+        }
     }
 
-    return search_result - haystack;
+    if (parameters.output_path != nullptr) {
+        WriteLine(context.output_file, line);
+        if (parameters.need_print) {
+            std::cout << line << std::endl;
+        }
+    }
+
+    return true;
 }
 
-bool IsNumeric(const char* str) {
-    for (size_t i = 0; i < std::strlen(str); ++i) {
-        if (!std::isdigit(str[i])) {
+// returns false when the end of the file is reached or the rest of the file is out of the time range
+bool ReadLine(AnalysisContext& context, std::ifstream& input_file, char* line_buffer, uint64_t& position) {
+    input_file.getline(line_buffer, kLineBufferSize);
+    position += input_file.gcount();
+
+    if (input_file.fail()) {
+        if (input_file.eof()) {
             return false;
         }
+
+        input_file.clear();
+        input_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        position += input_file.gcount();
+
+        ++context.lines_analyzed;
+        ++context.too_long_lines_amount;
+        return true;
     }
 
-    return true;
+    ++context.lines_analyzed;
+
+    return AnalyzeLine(context, line_buffer);
 }
 
-bool ParseLogEntry(LogEntry& to, const char* raw_entry) {
-    std::optional<size_t> remote_addr_length = FindSubstring(raw_entry, " - - ");
+void AnalyzeSampledBlocks(AnalysisContext& context, std::ifstream& input_file, char* line_buffer) {
+    uint64_t file_size = std::filesystem::file_size(context.parameters->logs_filenames.data[0]);
+    uint64_t blocks_amount = (file_size + kSampleBlockSize - 1) / kSampleBlockSize;
 
-    if (!remote_addr_length.has_value()) {
-        return false;
+    bool is_stopped = false;
+
+    for (uint64_t block = 0; block < blocks_amount && !is_stopped; ++block) {
+        ++context.sample.blocks_amount;
+
+        if (!IsBlockSampled(block, context.parameters->sample_rate)) {
+            continue;
+        }
+
+        // a line belongs to the block in which it starts, so the tail of the previous block's last line is skipped
+        uint64_t block_end = std::min(file_size, (block + 1) * kSampleBlockSize);
+        uint64_t position = 0;
+
+        input_file.clear();
+
+        if (block != 0) {
+            position = block * kSampleBlockSize - 1;
+            input_file.seekg(position);
+            input_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            position += input_file.gcount();
+        } else {
+            input_file.seekg(0);
+        }
+
+        uint64_t lines_before = context.matched_lines_amount;
+        uint64_t errors_before = context.server_error_lines_amount;
+
+        while (position < block_end) {
+            if (!ReadLine(context, input_file, line_buffer, position)) {
+                is_stopped = !input_file.eof();
+                break;
+            }
+        }
+
+        AddSampledBlock(context.sample, context.matched_lines_amount - lines_before, context.server_error_lines_amount - errors_before);
     }
+}
 
-    SetString(to.remote_addr, raw_entry, remote_addr_length.value());
+std::optional<const char*> AnalyzeLog(const Parameters& parameters) {
+    std::ifstream input_file(parameters.logs_filenames.data[0]);
+    if (input_file.fail()) {
+        return "Unable to read the input file";
+    }
 
-    size_t local_time_start = remote_addr_length.value() + std::strlen(" - - ");
-    std::optional<size_t> local_time_end = FindSubstring(raw_entry, "]", local_time_start);
+    AnalysisContext context;
+    context.parameters = &parameters;
 
-    if (raw_entry[local_time_start] != '[' || !local_time_end.has_value()) {
-        return false;
+    if (parameters.output_path != nullptr) {
+        if (!OpenBlockWriter(context.output_file, parameters.output_path, parameters.output_compression)) {
+            return "Unable to open the output file";
+        }
     }
 
-    size_t local_time_length = local_time_end.value() - local_time_start - 1;
-    std::string_view raw_local_time = std::string_view(raw_entry + local_time_start + 1, local_time_length);
+    if (parameters.invalid_lines_output_path != nullptr) {
+        if (!OpenBlockWriter(context.invalid_lines_output_file, parameters.invalid_lines_output_path, parameters.output_compression)) {
+            return "Unable to open the invalid lines output file";
+        }
+    }
 
-    std::optional<uint64_t> timestamp = LocalTimeStringToTimestamp(raw_local_time);
-    if (!timestamp.has_value()) {
-        return false;
+    if (parameters.histogram != 0) {
+        std::ios_base::openmode mode = (parameters.histogram_format == HistogramFormat::kBinary ? std::ios::binary : std::ios::openmode{});
+
+        context.histogram_output_file = std::ofstream(parameters.histogram_output_path, mode);
+        if (context.histogram_output_file.fail()) {
+            return "Unable to open the histogram output file";
+        }
+
+        context.histogram.bucket_length = parameters.histogram;
     }
 
-    to.timestamp = timestamp.value();
+    BuildLogFilter(context.filter, parameters.filter_patterns);
+    context.is_lazy = IsLazyParsingPossible(parameters);
 
-    if (to.timestamp == 0) {
-        return false;
+    InitWindow(context.window, parameters.window, parameters.alert_rate);
+    context.reorder_buffer.max_skew = parameters.max_skew;
+
+    char* line_buffer = new char[kLineBufferSize];
+
+    bool is_sampled = parameters.sample_rate < 1.0;
+
+    if (parameters.logs_filenames.size > 1) {
+        std::optional<const char*> merging_error = AnalyzeLogFiles(context);
+
+        if (merging_error.has_value() && context.error == nullptr) {
+            context.error = merging_error.value();
+        }
+    } else if (is_sampled) {
+        AnalyzeSampledBlocks(context, input_file, line_buffer);
+    } else {
+        AnalyzeColumnBatches(context, input_file);
     }
 
-    size_t request_start = local_time_end.value() + 2;
-    std::optional<size_t> request_end = FindSubstring(raw_entry, "\"", request_start + 1);
-    
-    if (raw_entry[request_start] != '"' || raw_entry[request_start - 1] != ' ' || !request_end.has_value()) {
-        return false;
+    if (context.error != nullptr) {
+        delete[] line_buffer;
+        FreeLogEntry(context.entry);
+        FreeLogFilter(context.filter);
+        FreeSpillRuns(context.spill_runs);
+
+        ClearStatistics(context.error_logs_stats);
+
+        if (context.error_logs_stats.data != nullptr) {
+            delete[] context.error_logs_stats.data;
+        }
+
+        FreeWindow(context.window);
+        FreeSecondCounts(context.second_counts);
+        FreeReorderBuffer(context.reorder_buffer);
+        FreeHistogram(context.histogram);
+
+        if (context.node_throughput != nullptr) {
+            delete[] context.node_throughput;
+        }
+
+        return context.error;
     }
 
-    SetString(to.request, raw_entry + request_start + 1, (request_end.value() - request_start - 1));
+    std::cout << "Analyzed " << context.lines_analyzed << " lines, " << context.server_error_lines_amount << " were with the code 5XX, "
+        << context.invalid_lines_amount << " were invalid, " << context.too_long_lines_amount << " were ignored (too long)";
 
-    size_t status_start = request_end.value() + 2;
-    std::optional<size_t> status_end = FindSubstring(raw_entry, " ", status_start);
-    
-    if (raw_entry[status_start - 1] != ' ' || !status_end.has_value() || status_end.value() - status_start != 3) {
-        return false;
+    if (context.is_lazy) {
+        std::cout << ", " << context.unparsed_lines_amount << " were not parsed (not 5XX by the status)";
     }
 
-    SetString(to.status, raw_entry + status_start, (status_end.value() - status_start));
+    if (!context.filter.is_empty) {
+        std::cout << ", " << context.filtered_lines_amount << " were filtered out";
+    }
 
-    if (!IsNumeric(to.status.data)) {
-        return false;
+    if (context.skipped_files_amount > 0) {
+        std::cout << ", " << context.skipped_files_amount << " file" << (context.skipped_files_amount == 1 ? " was" : "s were")
+                  << " skipped (out of the time range)";
     }
 
-    size_t bytes_sent_start = status_end.value() + 1;
+    std::cout << '.' << std::endl;
 
-    if (raw_entry[bytes_sent_start - 1] != ' ') {
-        return false;
+    if (is_sampled) {
+        PrintSampleEstimates(context);
     }
 
-    if (std::strlen(raw_entry + bytes_sent_start) == 1 && raw_entry[bytes_sent_start] == '-') {
-        to.bytes_sent = 0;
-    } else {
-        std::expected<int64_t, const char*> bytes_sent = ParseInt(raw_entry + bytes_sent_start);
-        if (!bytes_sent.has_value()) {
-            return false;
+    if (parameters.need_numa_stats && context.node_throughput != nullptr) {
+        PrintNodeThroughput(context);
+    }
+
+    if (context.node_throughput != nullptr) {
+        delete[] context.node_throughput;
+    }
+
+    FreeLogFilter(context.filter);
+
+    FreeLogEntry(context.entry);
+
+    delete[] line_buffer;
+
+    uint64_t timestamp;
+    bool is_server_error;
+
+    while (PopTimestamp(context.reorder_buffer, timestamp, is_server_error)) {
+        UpdateWindow(context.window, timestamp, is_server_error);
+    }
+
+    FreeReorderBuffer(context.reorder_buffer);
+    FinishWindow(context.window, context.last_timestamp);
+
+    if (context.spill_runs.size > 0) {
+        // the table has been spilled at least once, so the exact top is collected by merging the runs
+        StatsArray top_stats;
+
+        bool is_merged = SpillStatistics(context.spill_runs, context.error_logs_stats)
+                      && MergeRuns(context.spill_runs, top_stats, parameters.stats);
+
+        FreeSpillRuns(context.spill_runs);
+        ClearStatistics(context.error_logs_stats);
+        delete[] context.error_logs_stats.data;
+
+        if (!is_merged) {
+            ClearStatistics(top_stats);
+            delete[] top_stats.data;
+            FreeWindow(context.window);
+            FreeSecondCounts(context.second_counts);
+            return "Unable to merge temporary files";
         }
 
-        to.bytes_sent = bytes_sent.value();
+        context.error_logs_stats = top_stats;
     }
 
-    return true;
+    if (parameters.output_path != nullptr && parameters.stats > 0) {
+        SortByFrequency(context.error_logs_stats);
+        PrintStats(context.error_logs_stats, parameters.stats, is_sampled ? &context.sample : nullptr);
+    }
+
+    ClearStatistics(context.error_logs_stats);
+
+    if (context.error_logs_stats.data != nullptr) {
+        delete[] context.error_logs_stats.data;
+    }
+
+    if (parameters.histogram != 0) {
+        bool is_written = WriteHistogram(context.histogram, context.histogram_output_file, parameters.histogram_format);
+        FreeHistogram(context.histogram);
+
+        if (!is_written) {
+            FreeWindow(context.window);
+            FreeSecondCounts(context.second_counts);
+            return "Unable to write the histogram";
+        }
+    }
+
+    if (parameters.window > 0) {
+        // in the sampling mode blocks are read whole, so a window that fits into a sampled block is counted exactly
+        // and is not extrapolated
+        PrintWindow(context.window.result_lower_timestamp, context.window.result_higher_timestamp, context.window.max_amount_of_requests);
+
+        if (context.window.late_entries_amount > 0) {
+            std::cout << "\n" << context.window.late_entries_amount << " request"
+                      << (context.window.late_entries_amount == 1 ? " was" : "s were")
+                      << " out of order by more than the allowed skew and not counted in the window";
+        }
+
+        if (parameters.need_error_window) {
+            PrintErrorWindows(context.window);
+        }
+
+        if (parameters.alert_rate > 0) {
+            PrintAlerts(context.window);
+        }
+
+        if (parameters.window_top > 0) {
+            PrintTopWindows(context.second_counts, parameters.window, parameters.window_top);
+        }
+    }
+
+    FreeSecondCounts(context.second_counts);
+    FreeWindow(context.window);
+
+    // the writers have been filling the files in the background, a failed write shows up only now
+    bool is_output_written = CloseBlockWriter(context.output_file);
+    bool is_invalid_lines_output_written = CloseBlockWriter(context.invalid_lines_output_file);
+
+    if (!is_output_written || !is_invalid_lines_output_written) {
+        return "Unable to write the output file";
+    }
+
+    return std::nullopt;
 }
@@ -2,21 +2,99 @@
 
 #include "argparsing.hpp"
 #include "dynamic_arrays.hpp"
+#include "filtering.hpp"
+#include "histogram.hpp"
+#include "numa.hpp"
+#include "parsing.hpp"
+#include "sampling.hpp"
+#include "spilling.hpp"
+#include "window.hpp"
+#include "writing.hpp"
 
 #include <cstdint>
+#include <fstream>
 #include <optional>
+#include <string_view>
 
 const int32_t kLineBufferSize = 16384;
+const int64_t kBytesInMegabyte = 1024 * 1024;
 
-struct LogEntry {
-    DynamicString remote_addr;
-    DynamicString request;
-    DynamicString status;
-    
-    uint64_t timestamp = 0;
-    int64_t bytes_sent = -1;
+enum class LineClass : uint8_t {
+    kValid,
+    kFiltered,
+    kInvalid,
+    // the line cannot affect any of the requested outputs, so it was not parsed
+    kSkipped,
+};
+
+struct AnalysisContext {
+    const Parameters* parameters = nullptr;
+
+    BlockWriter output_file;
+    BlockWriter invalid_lines_output_file;
+    std::ofstream histogram_output_file;
+
+    LogFilter filter;
+    bool is_lazy = false;
+
+    StatsArray error_logs_stats;
+    SpillRuns spill_runs;
+    LogEntry entry;
+
+    Histogram histogram;
+    SecondCounts second_counts;
+
+    WindowState window;
+    ReorderBuffer reorder_buffer;
+
+    // the greatest timestamp among the analyzed entries
+    uint64_t last_timestamp = 0;
+
+    uint64_t lines_analyzed = 0;
+    uint64_t invalid_lines_amount = 0;
+    uint64_t server_error_lines_amount = 0;
+    uint64_t too_long_lines_amount = 0;
+    uint64_t filtered_lines_amount = 0;
+    // lines skipped by the lazy parsing, they are not counted as invalid even if their beginning is broken
+    uint64_t unparsed_lines_amount = 0;
+
+    // lines that passed the filters and the time range, the population extrapolated in the sampling mode
+    uint64_t matched_lines_amount = 0;
+
+    SampleAccumulator sample;
+
+    // input files which time range did not intersect with --from/--to
+    uint64_t skipped_files_amount = 0;
+
+    // filled by the multi-file analysis, one element per numa node
+    NodeThroughput* node_throughput = nullptr;
+    size_t nodes_amount = 0;
+
+    const char* error = nullptr;
 };
 
 std::optional<const char*> AnalyzeLog(const Parameters& parameters);
 
-bool ParseLogEntry(LogEntry& to, const char* raw_entry);
+bool AnalyzeLine(AnalysisContext& context, const char* line);
+
+bool AnalyzeEntry(AnalysisContext& context, uint64_t timestamp, bool is_server_error, int64_t bytes_sent,
+                  const char* request, const char* line);
+
+// passes an entry to the window directly or through the reorder buffer when --max-skew is set
+void UpdateWindowEntry(AnalysisContext& context, uint64_t timestamp, bool is_server_error);
+
+// window, top windows and histogram part of AnalyzeEntry
+void CountEntry(AnalysisContext& context, uint64_t timestamp, bool is_server_error, int64_t bytes_sent);
+
+// statistics and output part of AnalyzeEntry for a 5XX line, returns false on a failed spill
+bool CountServerError(AnalysisContext& context, const char* request, const char* line);
+
+LineClass ClassifyLine(const LogFilter& filter, LogEntry& entry, const char* line, bool is_lazy);
+
+bool IsLazyParsingPossible(const Parameters& parameters);
+
+std::optional<char> ReadStatusClassFromTail(const char* line, size_t length);
+
+bool IsBeyondTimeRange(const Parameters& parameters, uint64_t timestamp);
+
+bool IsInTimeRange(const Parameters& parameters, uint64_t timestamp);
@@ -5,7 +5,12 @@
 #include <iostream>
 #include <sstream>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <optional>
+#include <charconv>
+
+#include <glob.h>
 
 const char* kStatsShortArg = "-s";
 const char* kStatsLongArg = "--stats";
@@ -21,11 +26,41 @@ const char* kToShortArg = "-t";
 const char* kToLongArg = "--to";
 const char* kInvalidLinesShortArg = "-i";
 const char* kInvalidLinesLongArg = "--invalid-lines-output";
+const char* kCompressionLongArg = "--compression";
+const char* kIncludeLongArg = "--include";
+const char* kExcludeLongArg = "--exclude";
+const char* kSampleLongArg = "--sample";
+const char* kMemoryLimitLongArg = "--memory-limit";
+const char* kMaxSkewLongArg = "--max-skew";
+const char* kHistogramLongArg = "--histogram";
+const char* kHistogramOutputLongArg = "--histogram-output";
+const char* kHistogramFormatLongArg = "--histogram-format";
+const char* kWindowTopLongArg = "--window-top";
+const char* kErrorWindowLongArg = "--error-window";
+const char* kAlertRateLongArg = "--alert-rate";
+const char* kNormalizeLongArg = "--normalize";
+const char* kNumaStatsLongArg = "--numa-stats";
+const char* kServeLongArg = "--serve";
+const char* kFollowLongArg = "--follow";
 const char* kHelpShortArg = "-h";
 const char* kHelpLongArg = "--help";
 
 const char* kMissingArgumentMsg{"Unspecified argument value (unexpected end of argument sequence)"};
 
+const char* kCsvFormat = "csv";
+const char* kBinaryFormat = "binary";
+
+const char* kQueryRule = "query";
+const char* kIdsRule = "ids";
+const char* kMethodRule = "method";
+
+const char* kNoCompression = "none";
+const char* kGzipCompression = "gzip";
+
+const char* kRemoteAddrFieldPrefix = "addr:";
+const char* kRequestFieldPrefix = "request:";
+const char* kStatusFieldPrefix = "status:";
+
 std::expected<const char*, const char*> GetParameterInfo(std::string_view parameter) {
     if (parameter == kStatsLongArg || parameter == kStatsShortArg) {
         return "--stats=<amount> | -s <amount>             [int, >= 0, default=10]       Output first n most frequent requests "
@@ -42,18 +77,64 @@ std::expected<const char*, const char*> GetParameterInfo(std::string_view parame
                "If not specified, --stats and --print won't work.";
     } else if (parameter == kPrintLongArg || parameter == kPrintShortArg) {
         return "--print | -p                               [flag, optional]              If specified, 5XX requests will be printed to stdout";
+    } else if (parameter == kWindowTopLongArg) {
+        return "--window-top=<amount>                      [int, >= 0, default=0]        With --window, also output n busiest windows "
+               "which do not overlap each other";
+    } else if (parameter == kErrorWindowLongArg) {
+        return "--error-window                             [flag, optional]              With --window, also output the windows "
+               "with the most 5XX requests and with the highest share of them";
+    } else if (parameter == kAlertRateLongArg) {
+        return "--alert-rate=<rate>                        [float, (0, 1], optional]     With --window, output every interval in which "
+               "the share of 5XX requests in the window exceeded the rate";
+    } else if (parameter == kNormalizeLongArg) {
+        return "--normalize=<rule>[,<rule>...]             [string, optional]            Count 5XX requests after normalization: "
+               "query - strip the query string, ids - replace numeric path segments with {id}, method - drop the method and protocol";
+    } else if (parameter == kNumaStatsLongArg) {
+        return "--numa-stats                               [flag, optional]              For several input files, output the amount of "
+               "data read and the throughput of the workers of every NUMA node";
+    } else if (parameter == kServeLongArg) {
+        return "--serve=<socket path>                      [string, optional]            Load the logs into memory and answer queries "
+               "on the Unix socket until interrupted instead of printing a report";
+    } else if (parameter == kFollowLongArg) {
+        return "--follow                                   [flag, optional]              With --serve, keep loading lines appended to the logs";
     } else if (parameter == kHelpLongArg || parameter == kHelpShortArg) {
         return "--help | -h                                [flag, optional]              Show help and exit";
     } else if (parameter == kInvalidLinesLongArg || parameter == kInvalidLinesShortArg) {
         return "--invalid-lines-output=<path> | -i <path>  [string, optional]            Path to the file to which "
                "invalid lines from the input file will be written";
+    } else if (parameter == kCompressionLongArg) {
+        return "--compression=<none|gzip>                  [string, default=none]        Compression of the --output and "
+               "--invalid-lines-output files";
+    } else if (parameter == kIncludeLongArg) {
+        return "--include=<[field:]pattern>                [string, repeatable]          Analyze only lines which field contains "
+               "one of the patterns. Field is one of addr, request (default), status";
+    } else if (parameter == kExcludeLongArg) {
+        return "--exclude=<[field:]pattern>                [string, repeatable]          Skip lines which field contains "
+               "one of the patterns. Field is one of addr, request (default), status";
+    } else if (parameter == kSampleLongArg) {
+        return "--sample=<rate>                            [float, (0, 1], default=1]    Analyze only a random share of the file "
+               "(in blocks) and extrapolate the results with confidence intervals";
+    } else if (parameter == kMemoryLimitLongArg) {
+        return "--memory-limit=<megabytes>                 [int, >= 0, default=0]        Spill the 5XX requests statistics to "
+               "temporary files when it takes more memory. By default, memory is not limited";
+    } else if (parameter == kMaxSkewLongArg) {
+        return "--max-skew=<seconds>                       [int, >= 0, default=0]        Maximum amount of seconds by which "
+               "timestamps may go out of order, entries are reordered within it before the window calculation";
+    } else if (parameter == kHistogramLongArg) {
+        return "--histogram=<seconds>                      [int, >= 0, default=0]        Count requests, 5XX requests and sent bytes "
+               "in buckets of n seconds and write them to --histogram-output. By default, no histogram is calculated";
+    } else if (parameter == kHistogramOutputLongArg) {
+        return "--histogram-output=<path>                  [string, optional]            Path to the file to which the histogram will be written";
+    } else if (parameter == kHistogramFormatLongArg) {
+        return "--histogram-format=<csv|binary>            [string, default=csv]         Format of the histogram file. Binary rows are "
+               "4 little-endian uint64: timestamp, requests, 5XX requests, bytes";
     }
 
     return std::unexpected{"Cannot get parameter info: unknown parameter"};
 }
 
 void ShowHelpMessage() {
-    std::cout << "Usage: AnalyzeLog [OPTIONS] <logs_filename>" << std::endl << 
+    std::cout << "Usage: AnalyzeLog [OPTIONS] <logs_filename>..." << std::endl << 
         "Possible options:" << std::endl << "\t";
     std::cout << *GetParameterInfo(kOutputLongArg) << std::endl << '\t';
     std::cout << *GetParameterInfo(kPrintLongArg) << std::endl << '\t';
@@ -62,22 +143,76 @@ void ShowHelpMessage() {
     std::cout << *GetParameterInfo(kFromLongArg) << std::endl << '\t';
     std::cout << *GetParameterInfo(kToLongArg) << std::endl << '\t';
     std::cout << *GetParameterInfo(kInvalidLinesLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kCompressionLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kIncludeLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kExcludeLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kSampleLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kMemoryLimitLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kMaxSkewLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kHistogramLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kHistogramOutputLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kHistogramFormatLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kWindowTopLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kErrorWindowLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kAlertRateLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kNormalizeLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kNumaStatsLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kServeLongArg) << std::endl << '\t';
+    std::cout << *GetParameterInfo(kFollowLongArg) << std::endl << '\t';
     std::cout << *GetParameterInfo(kHelpLongArg) << std::endl << '\t';
 }
 
 std::optional<ParametersParseError> ValidateParameters(const Parameters& parameters) {
-    if (parameters.stats < 0 || parameters.window < 0 || parameters.from_time < 0 || parameters.to_time < 0) {
+    if (parameters.stats < 0 || parameters.window < 0 || parameters.from_time < 0 || parameters.to_time < 0
+        || parameters.memory_limit < 0 || parameters.max_skew < 0 || parameters.histogram < 0
+        || parameters.window_top < 0) {
         return MakeParametersParseError("Negative value for a positive integer argument");
     }
 
-    if (parameters.logs_filename != nullptr && !std::filesystem::exists(parameters.logs_filename)) {
-        return MakeParametersParseError("Cannot find input file");
+    if (!(parameters.sample_rate > 0 && parameters.sample_rate <= 1)) {
+        return MakeParametersParseError("Sample rate must be in the range (0, 1]");
     }
 
-    if (parameters.logs_filename == nullptr && !parameters.need_help) {
+    for (size_t i = 0; i < parameters.logs_filenames.size; ++i) {
+        if (!std::filesystem::exists(parameters.logs_filenames.data[i])) {
+            return MakeParametersParseError("Cannot find input file", parameters.logs_filenames.data[i]);
+        }
+    }
+
+    if (parameters.logs_filenames.size == 0 && !parameters.need_help) {
         return MakeParametersParseError("No logs filename is specified");
     }
 
+    if (parameters.histogram > 0 && parameters.histogram_output_path == nullptr) {
+        return MakeParametersParseError("No histogram output path is specified");
+    }
+
+    if (!IsCompressionSupported(parameters.output_compression)) {
+        return MakeParametersParseError("This build does not support gzip compression, it is enabled by -DANALYZELOG_WITH_ZLIB=ON");
+    }
+
+    if (!(parameters.alert_rate >= 0 && parameters.alert_rate <= 1)) {
+        return MakeParametersParseError("Alert rate must be in the range (0, 1]");
+    }
+
+    if ((parameters.need_error_window || parameters.alert_rate > 0 || parameters.window_top > 0) && parameters.window == 0) {
+        return MakeParametersParseError("--error-window, --alert-rate and --window-top need --window");
+    }
+
+    // the top windows are chosen among up to amount * (2 * window - 1) candidates
+    if (parameters.window_top > 0
+        && static_cast<uint64_t>(parameters.window_top) > SIZE_MAX / (2 * static_cast<uint64_t>(parameters.window) - 1)) {
+        return MakeParametersParseError("--window-top is too large for this --window");
+    }
+
+    if (parameters.need_follow && parameters.serve_path == nullptr) {
+        return MakeParametersParseError("--follow can only be used with --serve");
+    }
+
+    if (parameters.logs_filenames.size > 1 && parameters.sample_rate < 1) {
+        return MakeParametersParseError("Sampling is supported only for a single input file");
+    }
+
     return std::nullopt;
 }
 
@@ -101,6 +236,80 @@ std::expected<int64_t, const char*> ParseInt(std::string_view str) {
     return result;
 }
 
+FilterPattern ParseFilterPattern(char* raw_value, bool is_exclude) {
+    FilterPattern pattern;
+    pattern.is_exclude = is_exclude;
+
+    if (std::strncmp(raw_value, kRemoteAddrFieldPrefix, std::strlen(kRemoteAddrFieldPrefix)) == 0) {
+        pattern.field = FilterField::kRemoteAddr;
+        pattern.pattern = raw_value + std::strlen(kRemoteAddrFieldPrefix);
+    } else if (std::strncmp(raw_value, kStatusFieldPrefix, std::strlen(kStatusFieldPrefix)) == 0) {
+        pattern.field = FilterField::kStatus;
+        pattern.pattern = raw_value + std::strlen(kStatusFieldPrefix);
+    } else if (std::strncmp(raw_value, kRequestFieldPrefix, std::strlen(kRequestFieldPrefix)) == 0) {
+        pattern.field = FilterField::kRequest;
+        pattern.pattern = raw_value + std::strlen(kRequestFieldPrefix);
+    } else {
+        pattern.field = FilterField::kRequest;
+        pattern.pattern = raw_value;
+    }
+
+    return pattern;
+}
+
+std::expected<double, const char*> ParseFloat(std::string_view str) {
+    double result;
+    std::from_chars_result convertion_result = std::from_chars(str.data(), str.data() + str.size(), result);
+
+    if (convertion_result.ec == std::errc::invalid_argument || convertion_result.ptr != str.end()) {
+        return std::unexpected{"Cannot parse a number from non-numeric data"};
+    } else if (convertion_result.ec == std::errc::result_out_of_range) {
+        return std::unexpected{"The number is out of range"};
+    }
+
+    return result;
+}
+
+void AddLogsFilename(Parameters& parameters, char* argument) {
+    if (std::strpbrk(argument, "*?[") == nullptr || std::filesystem::exists(argument)) {
+        AddElement(parameters.logs_filenames, argument);
+        return;
+    }
+
+    // the pattern was quoted, so the shell has not expanded it
+    glob_t glob_result;
+
+    if (glob(argument, 0, nullptr, &glob_result) != 0) {
+        AddElement(parameters.logs_filenames, argument);
+        globfree(&glob_result);
+        return;
+    }
+
+    for (size_t i = 0; i < glob_result.gl_pathc; ++i) {
+        char* filename = new char[std::strlen(glob_result.gl_pathv[i]) + 1];
+        std::strcpy(filename, glob_result.gl_pathv[i]);
+        AddElement(parameters.logs_filenames, filename);
+    }
+
+    globfree(&glob_result);
+}
+
+std::optional<ParametersParseError> ParseNormalizationRules(NormalizationRules& rules, char* raw_value) {
+    for (char* rule = std::strtok(raw_value, ","); rule != nullptr; rule = std::strtok(nullptr, ",")) {
+        if (std::strcmp(rule, kQueryRule) == 0) {
+            rules.need_strip_query = true;
+        } else if (std::strcmp(rule, kIdsRule) == 0) {
+            rules.need_replace_ids = true;
+        } else if (std::strcmp(rule, kMethodRule) == 0) {
+            rules.need_drop_method = true;
+        } else {
+            return MakeParametersParseError("Unknown normalization rule", rule);
+        }
+    }
+
+    return std::nullopt;
+}
+
 bool SetFlag(Parameters& parameters, char* name) {
     if (std::strcmp(name, kPrintLongArg) == 0 || std::strcmp(name, kPrintShortArg) == 0) {
         parameters.need_print = true;
@@ -108,6 +317,15 @@ bool SetFlag(Parameters& parameters, char* name) {
     } else if (std::strcmp(name, kHelpLongArg) == 0 || std::strcmp(name, kHelpShortArg) == 0) {
         parameters.need_help = true;
         return true;
+    } else if (std::strcmp(name, kErrorWindowLongArg) == 0) {
+        parameters.need_error_window = true;
+        return true;
+    } else if (std::strcmp(name, kNumaStatsLongArg) == 0) {
+        parameters.need_numa_stats = true;
+        return true;
+    } else if (std::strcmp(name, kFollowLongArg) == 0) {
+        parameters.need_follow = true;
+        return true;
     }
 
     return false;
@@ -120,6 +338,50 @@ std::optional<ParametersParseError> ParseOption(Parameters& parameters, char* ar
     } else if (std::strncmp(argument, kInvalidLinesLongArg, name_length) == 0 || std::strncmp(argument, kInvalidLinesShortArg, name_length) == 0) {
         parameters.invalid_lines_output_path = raw_value;
         return std::nullopt;
+    } else if (std::strncmp(argument, kCompressionLongArg, name_length) == 0) {
+        if (std::strcmp(raw_value, kNoCompression) == 0) {
+            parameters.output_compression = OutputCompression::kNone;
+        } else if (std::strcmp(raw_value, kGzipCompression) == 0) {
+            parameters.output_compression = OutputCompression::kGzip;
+        } else {
+            return MakeParametersParseError("Unknown compression", raw_value);
+        }
+
+        return std::nullopt;
+    } else if (std::strncmp(argument, kIncludeLongArg, name_length) == 0) {
+        AddElement(parameters.filter_patterns, ParseFilterPattern(raw_value, false));
+        return std::nullopt;
+    } else if (std::strncmp(argument, kExcludeLongArg, name_length) == 0) {
+        AddElement(parameters.filter_patterns, ParseFilterPattern(raw_value, true));
+        return std::nullopt;
+    } else if (std::strncmp(argument, kHistogramOutputLongArg, name_length) == 0 && name_length > std::strlen(kHistogramLongArg)) {
+        parameters.histogram_output_path = raw_value;
+        return std::nullopt;
+    } else if (std::strncmp(argument, kHistogramFormatLongArg, name_length) == 0 && name_length > std::strlen(kHistogramLongArg)) {
+        if (std::strcmp(raw_value, kCsvFormat) == 0) {
+            parameters.histogram_format = HistogramFormat::kCsv;
+        } else if (std::strcmp(raw_value, kBinaryFormat) == 0) {
+            parameters.histogram_format = HistogramFormat::kBinary;
+        } else {
+            return MakeParametersParseError("Unknown histogram format", raw_value);
+        }
+
+        return std::nullopt;
+    } else if (std::strncmp(argument, kNormalizeLongArg, name_length) == 0) {
+        return ParseNormalizationRules(parameters.normalization_rules, raw_value);
+    } else if (std::strncmp(argument, kServeLongArg, name_length) == 0) {
+        parameters.serve_path = raw_value;
+        return std::nullopt;
+    } else if (std::strncmp(argument, kAlertRateLongArg, name_length) == 0) {
+        std::expected<double, const char*> rate = ParseFloat(raw_value);
+        if (!rate.has_value()) return MakeParametersParseError(rate.error(), argument);
+        parameters.alert_rate = rate.value();
+        return std::nullopt;
+    } else if (std::strncmp(argument, kSampleLongArg, name_length) == 0) {
+        std::expected<double, const char*> rate = ParseFloat(raw_value);
+        if (!rate.has_value()) return MakeParametersParseError(rate.error(), argument);
+        parameters.sample_rate = rate.value();
+        return std::nullopt;
     }
 
     std::expected<int64_t, const char*> number = ParseInt(raw_value);
@@ -127,8 +389,13 @@ std::optional<ParametersParseError> ParseOption(Parameters& parameters, char* ar
     if (std::strncmp(argument, kStatsLongArg, name_length) == 0 || std::strncmp(argument, kStatsShortArg, 2) == 0) {
         if (!number.has_value()) return MakeParametersParseError(number.error(), argument);
         parameters.stats = number.value();
+    } else if (std::strncmp(argument, kWindowTopLongArg, name_length) == 0 && name_length > std::strlen(kWindowLongArg)) {
+        if (!number.has_value()) return MakeParametersParseError(number.error(), argument);
+        if (number.value() > INT32_MAX) return MakeParametersParseError("The number is too large", argument);
+        parameters.window_top = number.value();
     } else if (std::strncmp(argument, kWindowLongArg, name_length) == 0 || std::strncmp(argument, kWindowShortArg, 2) == 0) {
         if (!number.has_value()) return MakeParametersParseError(number.error(), argument);
+        if (number.value() > INT32_MAX) return MakeParametersParseError("The number is too large", argument);
         parameters.window = number.value();
     } else if (std::strncmp(argument, kFromLongArg, name_length) == 0 || std::strncmp(argument, kFromShortArg, 2) == 0) {
         if (!number.has_value()) return MakeParametersParseError(number.error(), argument);
@@ -136,6 +403,15 @@ std::optional<ParametersParseError> ParseOption(Parameters& parameters, char* ar
     } else if (std::strncmp(argument, kToLongArg, name_length) == 0 || std::strncmp(argument, kToShortArg, 2) == 0) {
         if (!number.has_value()) return MakeParametersParseError(number.error(), argument);
         parameters.to_time = number.value();
+    } else if (std::strncmp(argument, kMemoryLimitLongArg, name_length) == 0) {
+        if (!number.has_value()) return MakeParametersParseError(number.error(), argument);
+        parameters.memory_limit = number.value();
+    } else if (std::strncmp(argument, kMaxSkewLongArg, name_length) == 0) {
+        if (!number.has_value()) return MakeParametersParseError(number.error(), argument);
+        parameters.max_skew = number.value();
+    } else if (std::strncmp(argument, kHistogramLongArg, name_length) == 0) {
+        if (!number.has_value()) return MakeParametersParseError(number.error(), argument);
+        parameters.histogram = number.value();
     } else {
         return MakeParametersParseError("Unknown argument", argument);
     }
@@ -152,7 +428,7 @@ std::expected<Parameters, ParametersParseError> ParseArguments(int argc, char**
         char* argument = argv[i];
 
         if (options_ended || argument[0] != '-' || std::strlen(argument) == 1) {
-            parameters.logs_filename = argument;
+            AddLogsFilename(parameters, argument);
             continue;
         }
 
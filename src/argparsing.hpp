@@ -1,5 +1,10 @@
 #pragma once
 
+#include "dynamic_arrays.hpp"
+#include "histogram.hpp"
+#include "normalizing.hpp"
+#include "writing.hpp"
+
 #include <cstdint>
 #include <expected>
 #include <string_view>
@@ -17,11 +22,34 @@ struct Parameters {
     int64_t from_time = 0;
     int64_t to_time = 0;
 
-    char* logs_filename = nullptr;
+    FilenamesArray logs_filenames;
 
     bool need_help = false;
 
     char* invalid_lines_output_path = nullptr;
+
+    OutputCompression output_compression = OutputCompression::kNone;
+
+    FilterPatternsArray filter_patterns;
+
+    double sample_rate = 1.0;
+    int64_t memory_limit = 0;
+    int32_t max_skew = 0;
+
+    int32_t window_top = 0;
+    bool need_error_window = false;
+    double alert_rate = 0;
+
+    int32_t histogram = 0;
+    char* histogram_output_path = nullptr;
+    HistogramFormat histogram_format = HistogramFormat::kCsv;
+
+    NormalizationRules normalization_rules;
+
+    bool need_numa_stats = false;
+
+    char* serve_path = nullptr;
+    bool need_follow = false;
 };
 
 ParametersParseError MakeParametersParseError(const char* message, const char* argument = nullptr);
@@ -33,3 +61,5 @@ std::expected<const char*, const char*> GetParameterInfo(std::string_view parame
 void ShowHelpMessage();
 
 std::expected<int64_t, const char*> ParseInt(std::string_view str);
+
+std::expected<double, const char*> ParseFloat(std::string_view str);
@@ -0,0 +1,294 @@
+#include "batching.hpp"
+#include "normalizing.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+bool IsColumnBatchFull(const ColumnBatch& batch) {
+    // a row may need space for a line and a request, both shorter than the line buffer
+    return batch.size == kColumnBatchSize || batch.text_size + 2 * kLineBufferSize > kColumnTextCapacity;
+}
+
+uint32_t CopyToText(ColumnBatch& batch, const char* string, size_t length) {
+    uint32_t offset = batch.text_size;
+
+    std::memcpy(batch.text + offset, string, length + 1);
+    batch.text_size += length + 1;
+
+    return offset;
+}
+
+void ParseRow(const AnalysisContext& context, LogEntry& entry, ColumnBatch& batch, size_t row, size_t length) {
+    const Parameters& parameters = *context.parameters;
+    const char* line = batch.line_buffer;
+
+    batch.timestamps[row] = 0;
+    batch.statuses[row] = 0;
+    batch.line_offsets[row] = kNoText;
+    batch.request_offsets[row] = kNoText;
+
+    LineClass line_class = ClassifyLine(context.filter, entry, line, context.is_lazy);
+    batch.line_classes[row] = static_cast<uint8_t>(line_class);
+
+    if (line_class == LineClass::kInvalid && parameters.invalid_lines_output_path != nullptr) {
+        batch.line_offsets[row] = CopyToText(batch, line, length);
+    }
+
+    if (line_class != LineClass::kValid) {
+        return;
+    }
+
+    batch.timestamps[row] = entry.timestamp;
+    batch.bytes_sent[row] = entry.bytes_sent;
+    batch.statuses[row] = (entry.status.data[0] - '0') * 100 + (entry.status.data[1] - '0') * 10 + (entry.status.data[2] - '0');
+
+    if (entry.status.data[0] != '5' || parameters.output_path == nullptr) {
+        return;
+    }
+
+    batch.line_offsets[row] = CopyToText(batch, line, length);
+
+    if (parameters.stats > 0) {
+        if (IsNormalizationEnabled(parameters.normalization_rules)) {
+            NormalizeRequest(entry.request, parameters.normalization_rules);
+        }
+
+        batch.request_offsets[row] = CopyToText(batch, entry.request.data, entry.request.size);
+    }
+}
+
+bool ReadColumnBatch(const AnalysisContext& context, LogEntry& entry, std::ifstream& input_file, ColumnBatch& batch,
+                     FileCounters& counters) {
+    batch.size = 0;
+    batch.text_size = 0;
+
+    while (!IsColumnBatchFull(batch)) {
+        size_t row = batch.size;
+
+        input_file.getline(batch.line_buffer, kLineBufferSize);
+        counters.bytes_read += input_file.gcount();
+
+        if (input_file.fail()) {
+            if (input_file.eof()) {
+                break;
+            }
+
+            input_file.clear();
+            input_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            counters.bytes_read += input_file.gcount();
+
+            batch.line_classes[row] = static_cast<uint8_t>(LineClass::kSkipped);
+            batch.is_too_long[row] = 1;
+            batch.timestamps[row] = 0;
+            batch.statuses[row] = 0;
+            ++batch.size;
+            continue;
+        }
+
+        // gcount includes the extracted delimiter unless the last line has none
+        size_t length = input_file.gcount() - (input_file.eof() ? 0 : 1);
+
+        batch.is_too_long[row] = 0;
+        ++batch.size;
+
+        ParseRow(context, entry, batch, row, length);
+    }
+
+    return batch.size > 0;
+}
+
+// returns the amount of rows before the first one beyond --to, which stops the analysis
+size_t FindStopRow(const AnalysisContext& context, const ColumnBatch& batch) {
+    const Parameters& parameters = *context.parameters;
+
+    if (parameters.to_time == 0) {
+        return batch.size;
+    }
+
+    for (size_t row = 0; row < batch.size; ++row) {
+        if (batch.line_classes[row] == static_cast<uint8_t>(LineClass::kValid) && IsBeyondTimeRange(parameters, batch.timestamps[row])) {
+            return row;
+        }
+    }
+
+    return batch.size;
+}
+
+// the passes below have no branches depending on the data, so the compiler can vectorize them
+void ComputeMasks(const AnalysisContext& context, ColumnBatch& batch) {
+    const Parameters& parameters = *context.parameters;
+
+    uint64_t from_time = parameters.from_time;
+    uint64_t to_time = (parameters.to_time == 0 ? UINT64_MAX : parameters.to_time);
+
+    for (size_t row = 0; row < batch.size; ++row) {
+        batch.is_matched[row] = (batch.line_classes[row] == static_cast<uint8_t>(LineClass::kValid))
+                              & (batch.timestamps[row] >= from_time) & (batch.timestamps[row] <= to_time);
+    }
+
+    for (size_t row = 0; row < batch.size; ++row) {
+        batch.is_server_error[row] = batch.is_matched[row] & (batch.statuses[row] >= 500) & (batch.statuses[row] < 600);
+    }
+}
+
+void CountLineClasses(const ColumnBatch& batch, FileCounters& counters) {
+    uint64_t too_long_amount = 0;
+    uint64_t invalid_amount = 0;
+    uint64_t filtered_amount = 0;
+    uint64_t unparsed_amount = 0;
+
+    for (size_t row = 0; row < batch.size; ++row) {
+        too_long_amount += batch.is_too_long[row];
+        invalid_amount += (batch.line_classes[row] == static_cast<uint8_t>(LineClass::kInvalid));
+        filtered_amount += (batch.line_classes[row] == static_cast<uint8_t>(LineClass::kFiltered));
+        unparsed_amount += (batch.line_classes[row] == static_cast<uint8_t>(LineClass::kSkipped)) & !batch.is_too_long[row];
+    }
+
+    counters.too_long_lines_amount += too_long_amount;
+    counters.invalid_lines_amount += invalid_amount;
+    counters.filtered_lines_amount += filtered_amount;
+    counters.unparsed_lines_amount += unparsed_amount;
+}
+
+bool MaskColumnBatch(const AnalysisContext& context, ColumnBatch& batch, FileCounters& counters) {
+    size_t size = FindStopRow(context, batch);
+    bool is_stopped = size < batch.size;
+
+    // the stopping line itself has been read, as in the line by line analysis
+    counters.lines_analyzed += size + (is_stopped ? 1 : 0);
+    batch.size = size;
+
+    ComputeMasks(context, batch);
+    CountLineClasses(batch, counters);
+
+    return is_stopped;
+}
+
+void CopyRow(const ColumnBatch& from, size_t from_row, ColumnBatch& to, size_t to_row) {
+    to.timestamps[to_row] = from.timestamps[from_row];
+    to.bytes_sent[to_row] = from.bytes_sent[from_row];
+    to.statuses[to_row] = from.statuses[from_row];
+    to.line_classes[to_row] = from.line_classes[from_row];
+    to.is_too_long[to_row] = from.is_too_long[from_row];
+    to.line_offsets[to_row] = from.line_offsets[from_row];
+    to.request_offsets[to_row] = from.request_offsets[from_row];
+    to.is_matched[to_row] = from.is_matched[from_row];
+    to.is_server_error[to_row] = from.is_server_error[from_row];
+}
+
+void AppendRow(ColumnBatch& batch, const ColumnBatch& from, size_t row) {
+    size_t to_row = batch.size++;
+    CopyRow(from, row, batch, to_row);
+
+    if (from.line_offsets[row] != kNoText) {
+        const char* line = from.text + from.line_offsets[row];
+        batch.line_offsets[to_row] = CopyToText(batch, line, std::strlen(line));
+    }
+
+    if (from.request_offsets[row] != kNoText) {
+        const char* request = from.text + from.request_offsets[row];
+        batch.request_offsets[to_row] = CopyToText(batch, request, std::strlen(request));
+    }
+}
+
+void CountRows(AnalysisContext& context, const ColumnBatch& batch) {
+    uint64_t matched_amount = 0;
+    uint64_t server_errors_amount = 0;
+    uint64_t last_timestamp = context.last_timestamp;
+
+    for (size_t row = 0; row < batch.size; ++row) {
+        matched_amount += batch.is_matched[row];
+        server_errors_amount += batch.is_server_error[row];
+    }
+
+    for (size_t row = 0; row < batch.size; ++row) {
+        last_timestamp = std::max(last_timestamp, batch.is_matched[row] ? batch.timestamps[row] : 0);
+    }
+
+    context.matched_lines_amount += matched_amount;
+    context.server_error_lines_amount += server_errors_amount;
+    context.last_timestamp = last_timestamp;
+}
+
+bool AnalyzeColumnBatch(AnalysisContext& context, const ColumnBatch& batch) {
+    const Parameters& parameters = *context.parameters;
+
+    CountRows(context, batch);
+
+    if (parameters.invalid_lines_output_path != nullptr) {
+        for (size_t row = 0; row < batch.size; ++row) {
+            if (batch.line_classes[row] == static_cast<uint8_t>(LineClass::kInvalid)) {
+                WriteLine(context.invalid_lines_output_file, batch.text + batch.line_offsets[row]);
+            }
+        }
+    }
+
+    // every consumer of the timestamps gets its own pass, the options are not checked per row
+    if (parameters.window != 0) {
+        for (size_t row = 0; row < batch.size; ++row) {
+            if (batch.is_matched[row]) {
+                UpdateWindowEntry(context, batch.timestamps[row], batch.is_server_error[row]);
+            }
+        }
+    }
+
+    if (parameters.window_top != 0) {
+        for (size_t row = 0; row < batch.size; ++row) {
+            if (batch.is_matched[row]) {
+                AddToSecondCounts(context.second_counts, batch.timestamps[row]);
+            }
+        }
+    }
+
+    if (parameters.histogram != 0) {
+        for (size_t row = 0; row < batch.size; ++row) {
+            if (batch.is_matched[row]) {
+                AddToHistogram(context.histogram, batch.timestamps[row], batch.is_server_error[row], batch.bytes_sent[row]);
+            }
+        }
+    }
+
+    if (parameters.output_path != nullptr) {
+        for (size_t row = 0; row < batch.size; ++row) {
+            if (!batch.is_server_error[row]) {
+                continue;
+            }
+
+            const char* request = (batch.request_offsets[row] == kNoText ? nullptr : batch.text + batch.request_offsets[row]);
+
+            if (!CountServerError(context, request, batch.text + batch.line_offsets[row])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void AddFileCounters(AnalysisContext& context, const FileCounters& counters) {
+    context.lines_analyzed += counters.lines_analyzed;
+    context.invalid_lines_amount += counters.invalid_lines_amount;
+    context.too_long_lines_amount += counters.too_long_lines_amount;
+    context.filtered_lines_amount += counters.filtered_lines_amount;
+    context.unparsed_lines_amount += counters.unparsed_lines_amount;
+}
+
+void AnalyzeColumnBatches(AnalysisContext& context, std::ifstream& input_file) {
+    ColumnBatch* batch = new ColumnBatch;
+    FileCounters counters;
+
+    bool is_stopped = false;
+
+    while (!is_stopped && ReadColumnBatch(context, context.entry, input_file, *batch, counters)) {
+        is_stopped = MaskColumnBatch(context, *batch, counters);
+
+        if (!AnalyzeColumnBatch(context, *batch)) {
+            break;
+        }
+    }
+
+    AddFileCounters(context, counters);
+
+    delete batch;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "analyzing.hpp"
+
+#include <cstdint>
+#include <fstream>
+
+const size_t kColumnBatchSize = 1024;
+const size_t kColumnTextCapacity = 256 * 1024;
+
+// offset of a string that is not kept in the batch
+const uint32_t kNoText = UINT32_MAX;
+
+// a block of lines split into columns: the lines are parsed one by one, and then the time range,
+// the status classes and the counters are computed by simple loops over whole columns
+struct ColumnBatch {
+    uint64_t timestamps[kColumnBatchSize];
+    int64_t bytes_sent[kColumnBatchSize];
+    uint16_t statuses[kColumnBatchSize];
+
+    // LineClass of every line, kValid marks the rows with parsed columns
+    uint8_t line_classes[kColumnBatchSize];
+    uint8_t is_too_long[kColumnBatchSize];
+
+    // only the lines and the requests that go to the outputs are kept in the text,
+    // the rest are parsed in the line buffer, which stays in the cache
+    uint32_t line_offsets[kColumnBatchSize];
+    uint32_t request_offsets[kColumnBatchSize];
+
+    // filled by the column passes
+    uint8_t is_matched[kColumnBatchSize];
+    uint8_t is_server_error[kColumnBatchSize];
+
+    size_t size = 0;
+
+    char text[kColumnTextCapacity];
+    size_t text_size = 0;
+
+    char line_buffer[kLineBufferSize];
+};
+
+// counters of the lines read from one file
+struct FileCounters {
+    uint64_t lines_analyzed = 0;
+    uint64_t invalid_lines_amount = 0;
+    uint64_t too_long_lines_amount = 0;
+    uint64_t filtered_lines_amount = 0;
+    uint64_t unparsed_lines_amount = 0;
+
+    uint64_t bytes_read = 0;
+    // reading and parsing only, without the time blocked on a full channel
+    double busy_seconds = 0;
+};
+
+bool IsColumnBatchFull(const ColumnBatch& batch);
+
+// returns false when there are no more lines
+bool ReadColumnBatch(const AnalysisContext& context, LogEntry& entry, std::ifstream& input_file, ColumnBatch& batch,
+                     FileCounters& counters);
+
+// cuts the batch before the first line beyond --to, fills the masks and counts the lines,
+// returns true if the file has to stop there
+bool MaskColumnBatch(const AnalysisContext& context, ColumnBatch& batch, FileCounters& counters);
+
+// copies the columns of a row, the texts stay where they are
+void CopyRow(const ColumnBatch& from, size_t from_row, ColumnBatch& to, size_t to_row);
+
+// adds a row of another batch to the end, with its texts
+void AppendRow(ColumnBatch& batch, const ColumnBatch& from, size_t row);
+
+// counts, outputs and windows for the masked rows, returns false on an error
+bool AnalyzeColumnBatch(AnalysisContext& context, const ColumnBatch& batch);
+
+void AddFileCounters(AnalysisContext& context, const FileCounters& counters);
+
+void AnalyzeColumnBatches(AnalysisContext& context, std::ifstream& input_file);
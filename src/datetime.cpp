@@ -1,5 +1,5 @@
 #include "datetime.hpp"
-#include "argparsing.hpp"
+#include "swar.hpp"
 
 #include <charconv>
 #include <cstring>
@@ -32,20 +32,27 @@ std::optional<uint8_t> GetDaysInMonth(uint8_t month, uint16_t year) {
     return kDaysInMonth[month - 1];
 }
 
+// number of leap years in [1, year)
+uint32_t CountLeapYearsBefore(uint16_t year) {
+    uint32_t years = year - 1;
+    return years / 4 - years / 100 + years / 400;
+}
+
 std::optional<uint64_t> DateTimeToTimestamp(const DateTime& datetime) {
+    if (datetime.month > 12) {
+        return std::nullopt;
+    }
+
     uint64_t result = 0;
 
-    for (uint16_t year = 1970; year < datetime.year; ++year) {
-        result += (IsLeapYear(year) ? 366 : 365) * 24 * 60 * 60;
+    if (datetime.year > 1970) {
+        uint64_t days = 365 * (datetime.year - 1970) + CountLeapYearsBefore(datetime.year) - CountLeapYearsBefore(1970);
+        result += days * 24 * 60 * 60;
     }
 
-    for (int8_t month = 1; month < datetime.month; ++month) {
-        std::optional<uint8_t> days_in_month = GetDaysInMonth(month, datetime.year);
-        if (!days_in_month.has_value()) {
-            return std::nullopt;
-        }
-
-        result += days_in_month.value() * 24 * 60 * 60;
+    if (datetime.month > 0) {
+        uint32_t days = kDaysBeforeMonth[datetime.month - 1] + (datetime.month > 2 && IsLeapYear(datetime.year) ? 1 : 0);
+        result += days * 24 * 60 * 60;
     }
 
     result += (datetime.day - 1) * 24 * 60 * 60;
@@ -57,90 +64,41 @@ std::optional<uint64_t> DateTimeToTimestamp(const DateTime& datetime) {
 }
 
 std::optional<uint64_t> LocalTimeStringToTimestamp(std::string_view local_time) {
-    DateTime datetime;
-
     // format: 01/Jul/1995:00:00:01 -0400
-
-    if (local_time[2] != '/') {
-        return std::nullopt;
-    }
-
-    std::expected<int64_t, const char*> day = ParseInt(local_time.substr(0, 2));
-    if (!day.has_value()) {
-        return std::nullopt;
-    }
-
-    local_time = local_time.substr(3);
-    
-    if (local_time[3] != '/') {
-        return std::nullopt;
-    }
-
-    std::optional<uint8_t> month = MonthToNumber(local_time.substr(0, 3));
-    if (!month.has_value()) {
-        return std::nullopt;
-    }
-
-    local_time = local_time.substr(4);
-
-    if (local_time[4] != ':') {
-        return std::nullopt;
-    }
-
-    std::expected<int64_t, const char*> year = ParseInt(local_time.substr(0, 4));
-    if (!year.has_value()) {
-        return std::nullopt;
-    }
-
-    local_time = local_time.substr(5);
-
-    if (local_time[2] != ':') {
-        return std::nullopt;
-    }
-
-    std::expected<int64_t, const char*> hours = ParseInt(local_time.substr(0, 2));
-    if (!hours.has_value()) {
-        return std::nullopt;
-    }
-
-    local_time = local_time.substr(3);
-
-    if (local_time[2] != ':') {
-        return std::nullopt;
-    }
-
-    std::expected<int64_t, const char*> minutes = ParseInt(local_time.substr(0, 2));
-    if (!minutes.has_value()) {
-        return std::nullopt;
-    }
-
-    local_time = local_time.substr(3);
-
-    if (local_time[2] != ' ') {
-        return std::nullopt;
-    }
-
-    std::expected<int64_t, const char*> seconds = ParseInt(local_time.substr(0, 2));
-    if (!seconds.has_value()) {
+    if (local_time.length() != kLocalTimeLength
+     || local_time[2] != '/'
+     || local_time[6] != '/'
+     || local_time[11] != ':'
+     || local_time[14] != ':'
+     || local_time[17] != ':'
+     || local_time[20] != ' ')
+    {
         return std::nullopt;
     }
 
-    std::string_view timezone = local_time.substr(3);
+    const char* data = local_time.data();
 
-    if (timezone.length() != 5 || (timezone[0] != '+' && timezone[0] != '-')) {
-        return std::nullopt;
-    }
+    std::optional<uint32_t> day = ParseTwoDigits(data);
+    std::optional<uint8_t> month = MonthToNumber(local_time.substr(3, 3));
+    std::optional<uint32_t> year = ParseFourDigits(data + 7);
+    std::optional<uint32_t> hours = ParseTwoDigits(data + 12);
+    std::optional<uint32_t> minutes = ParseTwoDigits(data + 15);
+    std::optional<uint32_t> seconds = ParseTwoDigits(data + 18);
+    std::optional<uint32_t> seconds_shift = ParseTimezoneShift(data + 21);
 
-    if (day.value() == -1 
-     || month.value() == -1 
-     || year.value() == -1 
-     || hours.value() == -1 
-     || minutes.value() == -1 
-     || seconds.value() == -1)
+    if (!day.has_value() 
+     || !month.has_value() 
+     || !year.has_value() 
+     || !hours.has_value() 
+     || !minutes.has_value() 
+     || !seconds.has_value()
+     || !seconds_shift.has_value())
     {
         return std::nullopt;
     }
 
+    DateTime datetime;
+
     datetime.day = day.value();
     datetime.month = month.value();
     datetime.year = year.value();
@@ -148,56 +106,47 @@ std::optional<uint64_t> LocalTimeStringToTimestamp(std::string_view local_time)
     datetime.minutes = minutes.value();
     datetime.seconds = seconds.value();
 
-    std::expected<int64_t, const char*> hours_shift = ParseInt(timezone.substr(1, 2));
-    if (!hours_shift.has_value()) {
-        return std::nullopt;
-    }
-
-    std::expected<int64_t, const char*> minutes_shift = ParseInt(timezone.substr(3, 2));
-    if (!minutes_shift.has_value()) {
-        return std::nullopt;
-    }
-
-    uint32_t seconds_shift = (hours_shift.value() * 60 * 60) + (minutes_shift.value() * 60);
     std::optional<uint64_t> result = DateTimeToTimestamp(datetime);
     if (!result.has_value()) {
         return std::nullopt;
     }
 
-    if (timezone[0] == '+') {
-        return result.value() - seconds_shift;
+    if (local_time[21] == '+') {
+        return result.value() - seconds_shift.value();
     }
     
-    return result.value() + seconds_shift;
+    return result.value() + seconds_shift.value();
 }
 
-void Convert2DigitNumberToString(uint8_t number, char buffer[3]) {
-    if (number < 10) {
-        std::snprintf(buffer, 3, "0%d", number);
-    } else {
-        std::snprintf(buffer, 3, "%d", number);
-    }
+char* WriteTwoDigits(uint32_t number, char* out) {
+    std::memcpy(out, kDigitPairs + 2 * number, 2);
+    return out + 2;
 }
 
-void TimestampToDateTimeString(uint64_t timestamp, char buffer[27]) {
+char* WriteDateTime(uint64_t timestamp, char* out) {
     DateTime datetime = TimestampToDateTime(timestamp);
 
-    // format: 01/Jul/1995:00:00:01 -0400 (length: 26 + '\0')
-    char day[3];
-    char month[4];
-    char year[6];
-    char hours[3];
-    char minutes[3];
-    char seconds[3];
-    
-    Convert2DigitNumberToString(datetime.day, day);
-    Convert2DigitNumberToString(datetime.hours, hours);
-    Convert2DigitNumberToString(datetime.minutes, minutes);
-    Convert2DigitNumberToString(datetime.seconds, seconds);
-
-    std::sprintf(year, "%d", datetime.year);
+    // format: 01/Jul/1995:00:00:01 +0000
+    out = WriteTwoDigits(datetime.day, out);
+    *out++ = '/';
+    std::memcpy(out, kMonthsList[datetime.month - 1], 3);
+    out += 3;
+    *out++ = '/';
+    out = WriteTwoDigits(datetime.year / 100 % 100, out);
+    out = WriteTwoDigits(datetime.year % 100, out);
+    *out++ = ':';
+    out = WriteTwoDigits(datetime.hours, out);
+    *out++ = ':';
+    out = WriteTwoDigits(datetime.minutes, out);
+    *out++ = ':';
+    out = WriteTwoDigits(datetime.seconds, out);
+    std::memcpy(out, " +0000", 6);
+
+    return out + 6;
+}
 
-    std::sprintf(buffer, "%2s/%3s/%4s:%2s:%2s:%2s +0000", day, kMonthsList[datetime.month - 1], year, hours, minutes, seconds);
+void TimestampToDateTimeString(uint64_t timestamp, char buffer[27]) {
+    *WriteDateTime(timestamp, buffer) = '\0';
 }
 
 DateTime TimestampToDateTime(uint64_t timestamp) {
@@ -209,39 +158,18 @@ DateTime TimestampToDateTime(uint64_t timestamp) {
     datetime.minutes = (seconds_in_current_day / 60) % 60;
     datetime.hours = seconds_in_current_day / (60 * 60);
 
-    int32_t days_left = (timestamp - seconds_in_current_day) / (60 * 60 * 24);
-
-    uint16_t year;
-    for (year = 1970; days_left >= (IsLeapYear(year) ? 366 : 365); ++year) {
-        days_left -= (IsLeapYear(year) ? 366 : 365);
-    }
-
-    datetime.year = year;
-
-    if (IsLeapYear(year)) {
-        ++days_left;
-    }
-
-    ++days_left;
-
-    uint8_t month = 0;
-    while (days_left > 0) {
-        if (month == 1 && IsLeapYear(year)) {
-            days_left -= 29;
-        } else {
-            days_left -= kDaysInMonth[month];
-        }
-
-        ++month;
-    }
-    
-    datetime.month = month;
-
-    if (month == 2 && IsLeapYear(year)) {
-        datetime.day = days_left + 29;
-    } else {
-        datetime.day = days_left + kDaysInMonth[month - 1];
-    }
+    // conversion of days to a civil date without loops: the year is shifted to start in March, so the leap day
+    // is the last one, and split into 400-year eras of 146097 days
+    uint64_t days = timestamp / (24 * 60 * 60) + kDaysFromEraStartToEpoch;
+    uint64_t era = days / kDaysInEra;
+    uint32_t day_of_era = days - era * kDaysInEra;
+    uint32_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    uint32_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    uint32_t shifted_month = (5 * day_of_year + 2) / 153;
+
+    datetime.day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+    datetime.month = (shifted_month < 10 ? shifted_month + 3 : shifted_month - 9);
+    datetime.year = era * 400 + year_of_era + (datetime.month <= 2 ? 1 : 0);
 
     return datetime;
 }
@@ -5,7 +5,21 @@
 #include <optional>
 
 constexpr const char* kMonthsList[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+// length of "01/Jul/1995:00:00:01 -0400"
+const size_t kLocalTimeLength = 26;
+
 constexpr int8_t kDaysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+constexpr int16_t kDaysBeforeMonth[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+// "00" "01" ... "99" written one after another
+constexpr char kDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+const uint32_t kDaysInEra = 146097;
+// days from 0000-03-01 to 1970-01-01
+const uint32_t kDaysFromEraStartToEpoch = 719468;
 
 struct DateTime {
     uint8_t day;
@@ -26,6 +40,9 @@ DateTime TimestampToDateTime(uint64_t timestamp);
 
 void TimestampToDateTimeString(uint64_t timestamp, char buffer[27]);
 
-bool IsLeapYear(uint8_t year);
+// writes the timestamp in the local_time format (26 characters, no terminating zero), returns the end of the output
+char* WriteDateTime(uint64_t timestamp, char* out);
+
+bool IsLeapYear(uint16_t year);
 
 std::optional<uint8_t> GetDaysInMonth(uint8_t month, uint16_t year);
@@ -1,7 +1,12 @@
 #include "dynamic_arrays.hpp"
+#include "interning.hpp"
+#include "numa.hpp"
 
 #include <iostream>
 #include <cstring>
+#include <algorithm>
+
+const size_t kInitialIndexSize = 1024;
 
 void AddElement(StatsArray& array, RequestStatistic element) {
     if (array.size == array.capacity) {
@@ -27,6 +32,121 @@ void AddElement(StatsArray& array, RequestStatistic element) {
     ++array.size;
 }
 
+void AddElement(FilterPatternsArray& array, FilterPattern element) {
+    if (array.size == array.capacity) {
+        if (array.capacity == 0) {
+            array.capacity = 1;
+        }
+
+        FilterPattern* new_data = new FilterPattern[array.capacity * 2];
+        array.capacity *= 2;
+
+        for (size_t i = 0; i < array.size; ++i) {
+            new_data[i] = array.data[i];
+        }
+
+        if (array.data != nullptr) {
+            delete[] array.data;
+        }
+
+        array.data = new_data;
+    }
+
+    array.data[array.size] = element;
+    ++array.size;
+}
+
+void AddElement(FilenamesArray& array, char* element) {
+    if (array.size == array.capacity) {
+        if (array.capacity == 0) {
+            array.capacity = 1;
+        }
+
+        char** new_data = new char*[array.capacity * 2];
+        array.capacity *= 2;
+
+        for (size_t i = 0; i < array.size; ++i) {
+            new_data[i] = array.data[i];
+        }
+
+        if (array.data != nullptr) {
+            delete[] array.data;
+        }
+
+        array.data = new_data;
+    }
+
+    array.data[array.size] = element;
+    ++array.size;
+}
+
+void DropIndex(StatsArray& array) {
+    if (array.index != nullptr) {
+        FreeLargeBuffer(array.index);
+    }
+
+    array.index = nullptr;
+    array.index_size = 0;
+}
+
+size_t FindIndexSlot(const StatsArray& array, std::string_view request) {
+    size_t mask = array.index_size - 1;
+    size_t slot = HashString(request) & mask;
+
+    while (array.index[slot] != kNoStringId) {
+        const char* stored = array.data[array.index[slot]].request;
+
+        if (std::strncmp(stored, request.data(), request.size()) == 0 && stored[request.size()] == '\0') {
+            return slot;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void RebuildIndex(StatsArray& array, size_t index_size) {
+    DropIndex(array);
+
+    array.index = static_cast<uint32_t*>(AllocateLargeBuffer(index_size * sizeof(uint32_t)));
+    array.index_size = index_size;
+    std::fill(array.index, array.index + index_size, kNoStringId);
+
+    for (uint32_t i = 0; i < array.size; ++i) {
+        array.index[FindIndexSlot(array, array.data[i].request)] = i;
+    }
+}
+
+RequestStatistic& FindOrAddRequest(StatsArray& array, std::string_view request) {
+    if (array.index == nullptr || 2 * (array.size + 1) > array.index_size) {
+        size_t index_size = std::max(kInitialIndexSize, array.index_size);
+
+        while (2 * (array.size + 1) > index_size) {
+            index_size *= 2;
+        }
+
+        RebuildIndex(array, index_size);
+    }
+
+    size_t slot = FindIndexSlot(array, request);
+
+    if (array.index[slot] != kNoStringId) {
+        return array.data[array.index[slot]];
+    }
+
+    RequestStatistic stat;
+    stat.request = new char[request.size() + 1];
+    std::memcpy(stat.request, request.data(), request.size());
+    stat.request[request.size()] = '\0';
+
+    array.strings_memory += request.size() + 1;
+    array.index[slot] = array.size;
+    AddElement(array, stat);
+
+    return array.data[array.size - 1];
+}
+
 void SortByFrequency(RequestStatistic* data, int32_t low, int32_t high) {
     int32_t i = low;
     int32_t j = high;
@@ -60,6 +180,8 @@ void SortByFrequency(RequestStatistic* data, int32_t low, int32_t high) {
 }
 
 void SortByFrequency(StatsArray& array) {
+    DropIndex(array);
+
     if (array.size < 2) {
         return;
     }
@@ -67,25 +189,59 @@ void SortByFrequency(StatsArray& array) {
     SortByFrequency(array.data, 0, array.size - 1);
 }
 
-void SetString(DynamicString& string, const char* src, size_t length) {
-    if (string.capacity == 0) {
-        string.capacity = 2;
+void SortByRequest(RequestStatistic* data, int32_t low, int32_t high) {
+    int32_t i = low;
+    int32_t j = high;
+    const char* pivot = data[(i + j) / 2].request;
+
+    while (i <= j) {
+        while (std::strcmp(data[i].request, pivot) < 0) {
+            ++i;
+        }
+
+        while (std::strcmp(data[j].request, pivot) > 0) {
+            --j;
+        }
+
+        if (i > j) {
+            continue;
+        }
+
+        std::swap(data[i], data[j]);
+        ++i;
+        --j;
     }
 
-    if (string.data == nullptr) {
-        string.data = new char[string.capacity];
+    if (j > low) {
+        SortByRequest(data, low, j);
     }
 
-    if (string.capacity < std::strlen(src) + 1) {
-        string.capacity = std::strlen(src) * 2;
+    if (i < high) {
+        SortByRequest(data, i, high);
+    }
+}
 
-        char* new_data = new char[string.capacity];
+void SortByRequest(StatsArray& array) {
+    DropIndex(array);
 
-        delete[] string.data;
-        string.data = new_data;
+    if (array.size < 2) {
+        return;
     }
     
-    std::strncpy(string.data, src, length);
-    string.data[length] = '\0';
-    string.size = std::strlen(src);
+    SortByRequest(array.data, 0, array.size - 1);
+}
+
+size_t GetMemoryUsage(const StatsArray& array) {
+    return array.capacity * sizeof(RequestStatistic) + array.index_size * sizeof(uint32_t) + array.strings_memory;
+}
+
+void ClearStatistics(StatsArray& array) {
+    for (size_t i = 0; i < array.size; ++i) {
+        delete[] array.data[i].request;
+    }
+
+    array.size = 0;
+    array.strings_memory = 0;
+
+    DropIndex(array);
 }
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "dynamic_string.hpp"
+
 #include <cstdint>
 #include <cstddef>
+#include <string_view>
 
 struct RequestStatistic {
     char* request = nullptr;
@@ -12,16 +15,52 @@ struct StatsArray {
     size_t capacity = 0;
     size_t size = 0;
     RequestStatistic* data = nullptr;
+
+    // memory taken by the request strings
+    size_t strings_memory = 0;
+
+    // open-addressing hash index of positions in data, dropped by sorting and rebuilt by FindOrAddRequest
+    uint32_t* index = nullptr;
+    size_t index_size = 0;
+};
+
+enum class FilterField : uint8_t {
+    kRemoteAddr,
+    kRequest,
+    kStatus,
+};
+
+struct FilterPattern {
+    const char* pattern = nullptr;
+    FilterField field = FilterField::kRequest;
+    bool is_exclude = false;
+};
+
+struct FilterPatternsArray {
+    size_t capacity = 0;
+    size_t size = 0;
+    FilterPattern* data = nullptr;
 };
 
-struct DynamicString {
-    char* data = nullptr;
+struct FilenamesArray {
     size_t capacity = 0;
     size_t size = 0;
+    char** data = nullptr;
 };
 
 void AddElement(StatsArray& array, RequestStatistic element);
 
+void AddElement(FilterPatternsArray& array, FilterPattern element);
+
+void AddElement(FilenamesArray& array, char* element);
+
+// returns the statistic of the request, a new one is added with zero frequency
+RequestStatistic& FindOrAddRequest(StatsArray& array, std::string_view request);
+
 void SortByFrequency(StatsArray& array);
 
-void SetString(DynamicString& string, const char* src, size_t length);
+void SortByRequest(StatsArray& array);
+
+size_t GetMemoryUsage(const StatsArray& array);
+
+void ClearStatistics(StatsArray& array);
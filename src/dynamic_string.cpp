@@ -0,0 +1,42 @@
+#include "dynamic_string.hpp"
+
+#include <cstring>
+
+void SetString(DynamicString& string, const char* src, size_t length) {
+    if (string.capacity == 0) {
+        string.capacity = 2;
+    }
+
+    if (string.data == nullptr) {
+        string.data = new char[string.capacity];
+    }
+
+    if (string.capacity < length + 1) {
+        string.capacity = (length + 1) * 2;
+
+        char* new_data = new char[string.capacity];
+
+        delete[] string.data;
+        string.data = new_data;
+    }
+    
+    std::strncpy(string.data, src, length);
+    string.data[length] = '\0';
+    string.size = length;
+}
+
+void ReserveString(DynamicString& string, size_t capacity) {
+    if (string.capacity >= capacity && string.data != nullptr) {
+        return;
+    }
+
+    char* new_data = new char[capacity];
+
+    if (string.data != nullptr) {
+        std::memcpy(new_data, string.data, string.size + 1);
+        delete[] string.data;
+    }
+
+    string.data = new_data;
+    string.capacity = capacity;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+struct DynamicString {
+    char* data = nullptr;
+    size_t capacity = 0;
+    size_t size = 0;
+};
+
+void SetString(DynamicString& string, const char* src, size_t length);
+
+// grows the string buffer to hold at least capacity characters keeping its contents
+void ReserveString(DynamicString& string, size_t capacity);
@@ -0,0 +1,160 @@
+#include "filtering.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+int32_t AddState(PatternAutomaton& automaton) {
+    if (automaton.states_amount == automaton.states_capacity) {
+        int32_t new_capacity = (automaton.states_capacity == 0 ? 16 : automaton.states_capacity * 2);
+
+        int32_t* new_transitions = new int32_t[static_cast<size_t>(new_capacity) * kAlphabetSize];
+        int32_t* new_fail_links = new int32_t[new_capacity];
+        uint8_t* new_outputs = new uint8_t[new_capacity];
+
+        if (automaton.transitions != nullptr) {
+            std::copy(automaton.transitions, automaton.transitions + static_cast<size_t>(automaton.states_amount) * kAlphabetSize, new_transitions);
+            std::copy(automaton.fail_links, automaton.fail_links + automaton.states_amount, new_fail_links);
+            std::copy(automaton.outputs, automaton.outputs + automaton.states_amount, new_outputs);
+
+            delete[] automaton.transitions;
+            delete[] automaton.fail_links;
+            delete[] automaton.outputs;
+        }
+
+        automaton.transitions = new_transitions;
+        automaton.fail_links = new_fail_links;
+        automaton.outputs = new_outputs;
+        automaton.states_capacity = new_capacity;
+    }
+
+    int32_t state = automaton.states_amount++;
+
+    std::fill(automaton.transitions + static_cast<size_t>(state) * kAlphabetSize,
+              automaton.transitions + static_cast<size_t>(state + 1) * kAlphabetSize, -1);
+    automaton.fail_links[state] = 0;
+    automaton.outputs[state] = 0;
+
+    return state;
+}
+
+void AddPattern(PatternAutomaton& automaton, const char* pattern, uint8_t output) {
+    if (automaton.states_amount == 0) {
+        AddState(automaton);
+    }
+
+    int32_t state = 0;
+
+    for (const char* c = pattern; *c != '\0'; ++c) {
+        size_t index = static_cast<size_t>(state) * kAlphabetSize + static_cast<uint8_t>(*c);
+
+        if (automaton.transitions[index] == -1) {
+            int32_t next_state = AddState(automaton);
+            automaton.transitions[index] = next_state;
+        }
+
+        state = automaton.transitions[index];
+    }
+
+    automaton.outputs[state] |= output;
+}
+
+void BuildTransitions(PatternAutomaton& automaton) {
+    int32_t* queue = new int32_t[automaton.states_amount];
+    int32_t queue_begin = 0;
+    int32_t queue_end = 0;
+
+    for (int32_t c = 0; c < kAlphabetSize; ++c) {
+        int32_t& next_state = automaton.transitions[c];
+
+        if (next_state == -1) {
+            next_state = 0;
+        } else {
+            automaton.fail_links[next_state] = 0;
+            queue[queue_end++] = next_state;
+        }
+    }
+
+    // breadth-first order guarantees that the fail link of a state is complete before the state itself
+    while (queue_begin < queue_end) {
+        int32_t state = queue[queue_begin++];
+        int32_t fail_state = automaton.fail_links[state];
+
+        automaton.outputs[state] |= automaton.outputs[fail_state];
+
+        for (int32_t c = 0; c < kAlphabetSize; ++c) {
+            int32_t& next_state = automaton.transitions[static_cast<size_t>(state) * kAlphabetSize + c];
+            int32_t fail_next_state = automaton.transitions[static_cast<size_t>(fail_state) * kAlphabetSize + c];
+
+            if (next_state == -1) {
+                next_state = fail_next_state;
+            } else {
+                automaton.fail_links[next_state] = fail_next_state;
+                queue[queue_end++] = next_state;
+            }
+        }
+    }
+
+    delete[] queue;
+}
+
+void BuildLogFilter(LogFilter& filter, const FilterPatternsArray& patterns) {
+    for (size_t i = 0; i < patterns.size; ++i) {
+        int32_t field = static_cast<int32_t>(patterns.data[i].field);
+
+        AddPattern(filter.automatons[field], patterns.data[i].pattern, patterns.data[i].is_exclude ? kExcludeMatch : kIncludeMatch);
+
+        filter.has_patterns[field] = true;
+        filter.has_includes[field] |= !patterns.data[i].is_exclude;
+        filter.is_empty = false;
+    }
+
+    for (int32_t field = 0; field < kFilterFieldsAmount; ++field) {
+        if (filter.has_patterns[field]) {
+            BuildTransitions(filter.automatons[field]);
+        }
+    }
+}
+
+void FreeLogFilter(LogFilter& filter) {
+    for (int32_t field = 0; field < kFilterFieldsAmount; ++field) {
+        PatternAutomaton& automaton = filter.automatons[field];
+
+        if (automaton.transitions != nullptr) {
+            delete[] automaton.transitions;
+            delete[] automaton.fail_links;
+            delete[] automaton.outputs;
+        }
+
+        automaton = PatternAutomaton{};
+    }
+}
+
+bool MatchesField(const LogFilter& filter, FilterField field, std::string_view value) {
+    int32_t field_index = static_cast<int32_t>(field);
+
+    if (!filter.has_patterns[field_index]) {
+        return true;
+    }
+
+    const PatternAutomaton& automaton = filter.automatons[field_index];
+
+    int32_t state = 0;
+    uint8_t matches = automaton.outputs[0];
+
+    for (size_t i = 0; i < value.size() && (matches & kExcludeMatch) == 0; ++i) {
+        state = automaton.transitions[static_cast<size_t>(state) * kAlphabetSize + static_cast<uint8_t>(value[i])];
+        matches |= automaton.outputs[state];
+    }
+
+    if ((matches & kExcludeMatch) != 0) {
+        return false;
+    }
+
+    return !filter.has_includes[field_index] || (matches & kIncludeMatch) != 0;
+}
+
+bool MatchesFilter(const LogFilter& filter, std::string_view remote_addr, std::string_view request, std::string_view status) {
+    return MatchesField(filter, FilterField::kStatus, status)
+        && MatchesField(filter, FilterField::kRequest, request)
+        && MatchesField(filter, FilterField::kRemoteAddr, remote_addr);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "dynamic_arrays.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+const int32_t kFilterFieldsAmount = 3;
+const int32_t kAlphabetSize = 256;
+
+const uint8_t kIncludeMatch = 1;
+const uint8_t kExcludeMatch = 2;
+
+// Aho-Corasick automaton, stored as a full transition table (every state has a move for every byte),
+// so the scan is a single table lookup per character
+struct PatternAutomaton {
+    int32_t* transitions = nullptr;
+    int32_t* fail_links = nullptr;
+    uint8_t* outputs = nullptr;
+
+    int32_t states_amount = 0;
+    int32_t states_capacity = 0;
+};
+
+struct LogFilter {
+    PatternAutomaton automatons[kFilterFieldsAmount];
+    bool has_patterns[kFilterFieldsAmount] = {};
+    bool has_includes[kFilterFieldsAmount] = {};
+    bool is_empty = true;
+};
+
+void BuildLogFilter(LogFilter& filter, const FilterPatternsArray& patterns);
+
+void FreeLogFilter(LogFilter& filter);
+
+bool MatchesFilter(const LogFilter& filter, std::string_view remote_addr, std::string_view request, std::string_view status);
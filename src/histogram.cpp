@@ -0,0 +1,141 @@
+#include "histogram.hpp"
+#include "datetime.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+const size_t kHistogramOutputBufferSize = 64 * 1024;
+const char* kHistogramCsvHeader = "timestamp,time,requests,server_errors,bytes_sent\n";
+
+void InsertHistogramChunk(Histogram& histogram, size_t index, uint64_t chunk_id) {
+    if (histogram.chunks_amount == histogram.chunks_capacity) {
+        size_t new_capacity = std::max<size_t>(histogram.chunks_capacity * 2, 16);
+        uint64_t* new_chunk_ids = new uint64_t[new_capacity];
+        HistogramBucket** new_chunks = new HistogramBucket*[new_capacity];
+
+        if (histogram.chunks != nullptr) {
+            std::copy(histogram.chunk_ids, histogram.chunk_ids + histogram.chunks_amount, new_chunk_ids);
+            std::copy(histogram.chunks, histogram.chunks + histogram.chunks_amount, new_chunks);
+            delete[] histogram.chunk_ids;
+            delete[] histogram.chunks;
+        }
+
+        histogram.chunk_ids = new_chunk_ids;
+        histogram.chunks = new_chunks;
+        histogram.chunks_capacity = new_capacity;
+    }
+
+    std::copy_backward(histogram.chunk_ids + index, histogram.chunk_ids + histogram.chunks_amount,
+                       histogram.chunk_ids + histogram.chunks_amount + 1);
+    std::copy_backward(histogram.chunks + index, histogram.chunks + histogram.chunks_amount,
+                       histogram.chunks + histogram.chunks_amount + 1);
+    ++histogram.chunks_amount;
+
+    histogram.chunk_ids[index] = chunk_id;
+    histogram.chunks[index] = new HistogramBucket[kBucketsInChunk];
+}
+
+void AddToHistogram(Histogram& histogram, uint64_t timestamp, bool is_server_error, int64_t bytes_sent) {
+    uint64_t bucket = timestamp / histogram.bucket_length;
+    uint64_t chunk_id = bucket / kBucketsInChunk;
+    size_t index = histogram.last_index;
+
+    if (index >= histogram.chunks_amount || histogram.chunk_ids[index] != chunk_id) {
+        index = std::lower_bound(histogram.chunk_ids, histogram.chunk_ids + histogram.chunks_amount, chunk_id) - histogram.chunk_ids;
+
+        if (index == histogram.chunks_amount || histogram.chunk_ids[index] != chunk_id) {
+            InsertHistogramChunk(histogram, index, chunk_id);
+        }
+
+        histogram.last_index = index;
+    }
+
+    HistogramBucket& entry = histogram.chunks[index][bucket % kBucketsInChunk];
+
+    ++entry.requests_amount;
+    entry.server_errors_amount += is_server_error ? 1 : 0;
+    entry.bytes_sent += std::max<int64_t>(bytes_sent, 0);
+
+    histogram.first_bucket = std::min(histogram.first_bucket, bucket);
+    histogram.last_bucket = std::max(histogram.last_bucket, bucket);
+}
+
+char* WriteNumber(uint64_t number, char* out) {
+    return std::to_chars(out, out + 20, number).ptr;
+}
+
+void WriteLittleEndian(uint64_t number, char* out) {
+    for (int32_t i = 0; i < 8; ++i) {
+        out[i] = static_cast<char>(number >> (8 * i));
+    }
+}
+
+bool WriteHistogram(const Histogram& histogram, std::ofstream& output_file, HistogramFormat format) {
+    char* buffer = new char[kHistogramOutputBufferSize];
+    char* out = buffer;
+
+    // a CSV row takes less than 128 bytes, a binary one is 4 numbers of 8 bytes
+    const size_t kMaxRowSize = 128;
+
+    if (format == HistogramFormat::kCsv) {
+        out = std::copy(kHistogramCsvHeader, kHistogramCsvHeader + std::strlen(kHistogramCsvHeader), out);
+    }
+
+    // empty buckets are written as rows, except for the whole chunks without entries: writing out a gap of decades
+    // would take as much space as keeping it in memory
+    for (size_t index = 0; index < histogram.chunks_amount; ++index) {
+        uint64_t chunk_first_bucket = histogram.chunk_ids[index] * kBucketsInChunk;
+        uint64_t first_bucket = std::max(histogram.first_bucket, chunk_first_bucket);
+        uint64_t last_bucket = std::min(histogram.last_bucket, chunk_first_bucket + kBucketsInChunk - 1);
+
+        for (uint64_t i = first_bucket; i <= last_bucket; ++i) {
+            const HistogramBucket& bucket = histogram.chunks[index][i - chunk_first_bucket];
+            uint64_t timestamp = i * histogram.bucket_length;
+
+            if (format == HistogramFormat::kCsv) {
+                out = WriteNumber(timestamp, out);
+                *out++ = ',';
+                out = WriteDateTime(timestamp, out);
+                *out++ = ',';
+                out = WriteNumber(bucket.requests_amount, out);
+                *out++ = ',';
+                out = WriteNumber(bucket.server_errors_amount, out);
+                *out++ = ',';
+                out = WriteNumber(bucket.bytes_sent, out);
+                *out++ = '\n';
+            } else {
+                WriteLittleEndian(timestamp, out);
+                WriteLittleEndian(bucket.requests_amount, out + 8);
+                WriteLittleEndian(bucket.server_errors_amount, out + 16);
+                WriteLittleEndian(bucket.bytes_sent, out + 24);
+                out += 32;
+            }
+
+            if (out + kMaxRowSize > buffer + kHistogramOutputBufferSize) {
+                output_file.write(buffer, out - buffer);
+                out = buffer;
+            }
+        }
+    }
+
+    output_file.write(buffer, out - buffer);
+    output_file.flush();
+
+    delete[] buffer;
+
+    return !output_file.fail();
+}
+
+void FreeHistogram(Histogram& histogram) {
+    for (size_t i = 0; i < histogram.chunks_amount; ++i) {
+        delete[] histogram.chunks[i];
+    }
+
+    if (histogram.chunks != nullptr) {
+        delete[] histogram.chunk_ids;
+        delete[] histogram.chunks;
+    }
+
+    histogram = Histogram{};
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+
+enum class HistogramFormat : uint8_t {
+    kCsv,
+    kBinary,
+};
+
+struct HistogramBucket {
+    uint64_t requests_amount = 0;
+    uint64_t server_errors_amount = 0;
+    uint64_t bytes_sent = 0;
+};
+
+const uint64_t kBucketsInChunk = 1 << 12;
+
+// buckets (timestamp / bucket_length) stored in chunks, only the chunks with entries are allocated
+// and they are kept sorted by their numbers, so a stray timestamp far from the rest costs one chunk and not the whole gap
+struct Histogram {
+    uint32_t bucket_length = 0;
+
+    uint64_t* chunk_ids = nullptr;
+    HistogramBucket** chunks = nullptr;
+    size_t chunks_amount = 0;
+    size_t chunks_capacity = 0;
+
+    // chunk of the previous entry, the next one usually falls into it
+    size_t last_index = 0;
+
+    uint64_t first_bucket = UINT64_MAX;
+    uint64_t last_bucket = 0;
+};
+
+void AddToHistogram(Histogram& histogram, uint64_t timestamp, bool is_server_error, int64_t bytes_sent);
+
+bool WriteHistogram(const Histogram& histogram, std::ofstream& output_file, HistogramFormat format);
+
+void FreeHistogram(Histogram& histogram);
@@ -0,0 +1,132 @@
+#include "interning.hpp"
+#include "numa.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+const size_t kInitialSlotsAmount = 1024;
+
+uint64_t HashString(std::string_view string) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (char c : string) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+size_t FindSlot(const StringDictionary& dictionary, std::string_view string, uint64_t hash) {
+    size_t mask = dictionary.slots_amount - 1;
+    size_t slot = hash & mask;
+
+    while (dictionary.slots[slot] != kNoStringId) {
+        uint32_t id = dictionary.slots[slot];
+
+        if (dictionary.lengths[id] == string.size() && std::memcmp(dictionary.strings[id], string.data(), string.size()) == 0) {
+            return slot;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void Rehash(StringDictionary& dictionary, size_t slots_amount) {
+    uint32_t* new_slots = static_cast<uint32_t*>(AllocateLargeBuffer(slots_amount * sizeof(uint32_t)));
+    std::fill(new_slots, new_slots + slots_amount, kNoStringId);
+
+    if (dictionary.slots != nullptr) {
+        FreeLargeBuffer(dictionary.slots);
+    }
+
+    dictionary.slots = new_slots;
+    dictionary.slots_amount = slots_amount;
+
+    for (uint32_t id = 0; id < dictionary.size; ++id) {
+        std::string_view string(dictionary.strings[id], dictionary.lengths[id]);
+        dictionary.slots[FindSlot(dictionary, string, HashString(string))] = id;
+    }
+}
+
+void AddString(StringDictionary& dictionary, std::string_view string) {
+    if (dictionary.size == dictionary.capacity) {
+        size_t new_capacity = (dictionary.capacity == 0 ? 16 : dictionary.capacity * 2);
+
+        char** new_strings = new char*[new_capacity];
+        uint32_t* new_lengths = new uint32_t[new_capacity];
+
+        if (dictionary.strings != nullptr) {
+            std::copy(dictionary.strings, dictionary.strings + dictionary.size, new_strings);
+            std::copy(dictionary.lengths, dictionary.lengths + dictionary.size, new_lengths);
+
+            delete[] dictionary.strings;
+            delete[] dictionary.lengths;
+        }
+
+        dictionary.strings = new_strings;
+        dictionary.lengths = new_lengths;
+        dictionary.capacity = new_capacity;
+    }
+
+    char* copy = new char[string.size() + 1];
+    std::memcpy(copy, string.data(), string.size());
+    copy[string.size()] = '\0';
+
+    dictionary.strings[dictionary.size] = copy;
+    dictionary.lengths[dictionary.size] = string.size();
+    ++dictionary.size;
+
+    dictionary.strings_memory += string.size() + 1;
+}
+
+uint32_t InternString(StringDictionary& dictionary, std::string_view string) {
+    if (dictionary.slots == nullptr) {
+        Rehash(dictionary, kInitialSlotsAmount);
+    }
+
+    uint64_t hash = HashString(string);
+    size_t slot = FindSlot(dictionary, string, hash);
+
+    if (dictionary.slots[slot] != kNoStringId) {
+        return dictionary.slots[slot];
+    }
+
+    uint32_t id = dictionary.size;
+    AddString(dictionary, string);
+    dictionary.slots[slot] = id;
+
+    if (2 * dictionary.size > dictionary.slots_amount) {
+        Rehash(dictionary, dictionary.slots_amount * 2);
+    }
+
+    return id;
+}
+
+uint32_t FindString(const StringDictionary& dictionary, std::string_view string) {
+    if (dictionary.slots == nullptr) {
+        return kNoStringId;
+    }
+
+    return dictionary.slots[FindSlot(dictionary, string, HashString(string))];
+}
+
+void FreeStringDictionary(StringDictionary& dictionary) {
+    for (size_t i = 0; i < dictionary.size; ++i) {
+        delete[] dictionary.strings[i];
+    }
+
+    if (dictionary.strings != nullptr) {
+        delete[] dictionary.strings;
+        delete[] dictionary.lengths;
+    }
+
+    if (dictionary.slots != nullptr) {
+        FreeLargeBuffer(dictionary.slots);
+    }
+
+    dictionary = StringDictionary{};
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+const uint32_t kNoStringId = UINT32_MAX;
+
+// open-addressing hash table which gives every distinct string a dense id
+struct StringDictionary {
+    char** strings = nullptr;
+    uint32_t* lengths = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    // slots keep string ids, the table is at most half full
+    uint32_t* slots = nullptr;
+    size_t slots_amount = 0;
+
+    size_t strings_memory = 0;
+};
+
+uint64_t HashString(std::string_view string);
+
+uint32_t InternString(StringDictionary& dictionary, std::string_view string);
+
+uint32_t FindString(const StringDictionary& dictionary, std::string_view string);
+
+void FreeStringDictionary(StringDictionary& dictionary);
@@ -3,6 +3,7 @@
 #include <expected>
 
 #include "analyzing.hpp"
+#include "serving.hpp"
 
 int main(int argc, char** argv){
     if (argc < 2) {
@@ -28,7 +29,7 @@ int main(int argc, char** argv){
         return EXIT_SUCCESS;
     }
 
-    std::optional<const char*> analyzing_error = AnalyzeLog(params.value());
+    std::optional<const char*> analyzing_error = (params->serve_path != nullptr ? ServeLog(params.value()) : AnalyzeLog(params.value()));
     
     if (analyzing_error.has_value()) {
         std::cerr << "An error occured while analyzing the file:\n" << analyzing_error.value();
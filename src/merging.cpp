@@ -0,0 +1,424 @@
+#include "merging.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <thread>
+#include <utility>
+
+const int32_t kProbedLinesAmount = 16;
+
+struct FileStream {
+    const char* filename = nullptr;
+
+    BatchChannel channel;
+    FileCounters counters;
+    std::thread worker;
+
+    // -1 leaves the worker to the scheduler
+    int32_t cpu = -1;
+    size_t node_index = 0;
+
+    ColumnBatch* batch = nullptr;
+    size_t position = 0;
+};
+
+bool PushBatch(BatchChannel& channel, ColumnBatch* batch) {
+    std::unique_lock lock(channel.mutex);
+    channel.changed.wait(lock, [&channel]() { return channel.size < kChannelCapacity || channel.is_cancelled; });
+
+    if (channel.is_cancelled) {
+        return false;
+    }
+
+    channel.batches[(channel.begin + channel.size) % kChannelCapacity] = batch;
+    ++channel.size;
+
+    channel.changed.notify_all();
+    return true;
+}
+
+void FinishChannel(BatchChannel& channel, bool is_failed) {
+    std::lock_guard lock(channel.mutex);
+    channel.is_finished = true;
+    channel.is_failed = is_failed;
+    channel.changed.notify_all();
+}
+
+void CancelChannel(BatchChannel& channel) {
+    std::lock_guard lock(channel.mutex);
+    channel.is_cancelled = true;
+    channel.changed.notify_all();
+}
+
+// returns nullptr when the worker has finished and all its batches are taken
+ColumnBatch* PopBatch(BatchChannel& channel) {
+    std::unique_lock lock(channel.mutex);
+    channel.changed.wait(lock, [&channel]() { return channel.size > 0 || channel.is_finished; });
+
+    if (channel.size == 0) {
+        return nullptr;
+    }
+
+    ColumnBatch* batch = channel.batches[channel.begin];
+    channel.begin = (channel.begin + 1) % kChannelCapacity;
+    --channel.size;
+
+    channel.changed.notify_all();
+    return batch;
+}
+
+// the time spent waiting for the merging thread is not a part of the worker's own reading and parsing
+bool PushBatchUntimed(FileStream& stream, ColumnBatch* batch, double& blocked_seconds) {
+    std::chrono::steady_clock::time_point push_time = std::chrono::steady_clock::now();
+    bool is_pushed = PushBatch(stream.channel, batch);
+
+    blocked_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - push_time).count();
+
+    return is_pushed;
+}
+
+// keeps the rows which reach the analysis, the texts stay in place
+void CompactColumnBatch(const AnalysisContext& context, ColumnBatch& batch, uint64_t& last_timestamp) {
+    bool need_invalid_lines = context.parameters->invalid_lines_output_path != nullptr;
+    size_t size = 0;
+
+    for (size_t row = 0; row < batch.size; ++row) {
+        if (batch.is_matched[row]) {
+            last_timestamp = batch.timestamps[row];
+        } else if (need_invalid_lines && batch.line_classes[row] == static_cast<uint8_t>(LineClass::kInvalid)) {
+            // invalid lines are ordered after the last valid one from the same file
+            batch.timestamps[row] = last_timestamp;
+        } else {
+            continue;
+        }
+
+        CopyRow(batch, row, batch, size++);
+    }
+
+    batch.size = size;
+}
+
+void ParseLogFile(const AnalysisContext& context, FileStream& stream) {
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    double blocked_seconds = 0;
+
+    // the buffers are allocated after pinning, so they are placed on the node of the worker
+    if (stream.cpu != -1) {
+        PinCurrentThread(stream.cpu);
+    }
+
+    LogEntry entry;
+    char* read_buffer = nullptr;
+    ColumnBatch* batch = nullptr;
+
+    uint64_t last_timestamp = 0;
+    bool is_stopped = false;
+    bool is_failed = false;
+
+    // an exception must not leave the thread, so a failed allocation is passed to the merging thread through the channel
+    try {
+        read_buffer = static_cast<char*>(AllocateLargeBuffer(kWorkerReadBufferSize));
+
+        std::ifstream input_file;
+        input_file.rdbuf()->pubsetbuf(read_buffer, kWorkerReadBufferSize);
+        input_file.open(stream.filename);
+
+        batch = new ColumnBatch;
+
+        while (!is_stopped && !stream.channel.is_cancelled && ReadColumnBatch(context, entry, input_file, *batch, stream.counters)) {
+            is_stopped = MaskColumnBatch(context, *batch, stream.counters);
+            CompactColumnBatch(context, *batch, last_timestamp);
+
+            if (batch->size == 0) {
+                continue;
+            }
+
+            // a batch rejected by a cancelled channel is freed below
+            if (!PushBatchUntimed(stream, batch, blocked_seconds)) {
+                break;
+            }
+
+            // the pushed batch belongs to the merging thread now, a failed allocation must not free it
+            batch = nullptr;
+            batch = new ColumnBatch;
+        }
+    } catch (const std::bad_alloc&) {
+        is_failed = true;
+    }
+
+    delete batch;
+
+    FinishChannel(stream.channel, is_failed);
+
+    FreeLogEntry(entry);
+
+    if (read_buffer != nullptr) {
+        FreeLargeBuffer(read_buffer);
+    }
+
+    stream.counters.busy_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() - blocked_seconds;
+}
+
+bool ReadFileTimeRange(const char* filename, uint64_t& first_timestamp, uint64_t& last_timestamp) {
+    std::ifstream input_file(filename);
+    if (input_file.fail()) {
+        return false;
+    }
+
+    char* line_buffer = new char[kLineBufferSize];
+    LogEntry entry;
+
+    bool has_first = false;
+    bool has_last = false;
+
+    for (int32_t i = 0; i < kProbedLinesAmount && !has_first && input_file.getline(line_buffer, kLineBufferSize); ++i) {
+        if (ParseLogEntry(entry, line_buffer)) {
+            first_timestamp = entry.timestamp;
+            has_first = true;
+        }
+    }
+
+    // the last timestamp is searched in the tail of the file, which holds at least a few lines
+    uint64_t file_size = std::filesystem::file_size(filename);
+    uint64_t tail_size = std::min<uint64_t>(file_size, kProbedLinesAmount * kLineBufferSize);
+
+    input_file.clear();
+    input_file.seekg(file_size - tail_size);
+
+    if (tail_size != file_size) {
+        input_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+
+    while (input_file.getline(line_buffer, kLineBufferSize) || (input_file.fail() && !input_file.eof())) {
+        if (input_file.fail()) {
+            input_file.clear();
+            input_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            continue;
+        }
+
+        if (ParseLogEntry(entry, line_buffer)) {
+            last_timestamp = entry.timestamp;
+            has_last = true;
+        }
+    }
+
+    FreeLogEntry(entry);
+    delete[] line_buffer;
+
+    return has_first && has_last;
+}
+
+bool IsFileOutOfTimeRange(const Parameters& parameters, const char* filename) {
+    if (parameters.from_time == 0 && parameters.to_time == 0) {
+        return false;
+    }
+
+    uint64_t first_timestamp;
+    uint64_t last_timestamp;
+
+    if (!ReadFileTimeRange(filename, first_timestamp, last_timestamp)) {
+        return false;
+    }
+
+    // within a file timestamps may go out of order by max_skew seconds
+    return last_timestamp + parameters.max_skew < parameters.from_time
+        || (parameters.to_time != 0 && first_timestamp > parameters.to_time + parameters.max_skew);
+}
+
+uint64_t GetStreamKey(const FileStream& stream) {
+    if (stream.batch == nullptr) {
+        return UINT64_MAX;
+    }
+
+    return stream.batch->timestamps[stream.position];
+}
+
+bool IsStreamBefore(const FileStream* streams, size_t lhs, size_t rhs) {
+    uint64_t lhs_key = GetStreamKey(streams[lhs]);
+    uint64_t rhs_key = GetStreamKey(streams[rhs]);
+
+    return lhs_key < rhs_key || (lhs_key == rhs_key && lhs < rhs);
+}
+
+// loser tree: leaves are the streams (nodes k..2k-1), internal nodes keep the loser of their match
+// and nodes[0] keeps the overall winner, so replacing the winner takes log(k) comparisons
+size_t BuildLoserTree(size_t* nodes, const FileStream* streams, size_t streams_amount, size_t node) {
+    if (node >= streams_amount) {
+        return node - streams_amount;
+    }
+
+    size_t left_winner = BuildLoserTree(nodes, streams, streams_amount, 2 * node);
+    size_t right_winner = BuildLoserTree(nodes, streams, streams_amount, 2 * node + 1);
+
+    if (IsStreamBefore(streams, left_winner, right_winner)) {
+        nodes[node] = right_winner;
+        return left_winner;
+    }
+
+    nodes[node] = left_winner;
+    return right_winner;
+}
+
+void ReplayLoserTree(size_t* nodes, const FileStream* streams, size_t streams_amount) {
+    size_t winner = nodes[0];
+
+    for (size_t node = (winner + streams_amount) / 2; node > 0; node /= 2) {
+        if (IsStreamBefore(streams, nodes[node], winner)) {
+            std::swap(nodes[node], winner);
+        }
+    }
+
+    nodes[0] = winner;
+}
+
+// the worker has finished early because it could not allocate its buffers
+bool IsStreamFailed(const FileStream& stream) {
+    return stream.batch == nullptr && stream.channel.is_failed;
+}
+
+void AdvanceStream(FileStream& stream) {
+    ++stream.position;
+
+    if (stream.position < stream.batch->size) {
+        return;
+    }
+
+    delete stream.batch;
+
+    stream.batch = PopBatch(stream.channel);
+    stream.position = 0;
+}
+
+std::optional<const char*> AnalyzeLogFiles(AnalysisContext& context) {
+    const Parameters& parameters = *context.parameters;
+    const FilenamesArray& filenames = parameters.logs_filenames;
+
+    for (size_t i = 0; i < filenames.size; ++i) {
+        if (std::ifstream(filenames.data[i]).fail()) {
+            return "Unable to read the input file";
+        }
+    }
+
+    FileStream* streams = new FileStream[filenames.size];
+    size_t streams_amount = 0;
+
+    for (size_t i = 0; i < filenames.size; ++i) {
+        if (IsFileOutOfTimeRange(parameters, filenames.data[i])) {
+            ++context.skipped_files_amount;
+            continue;
+        }
+
+        streams[streams_amount++].filename = filenames.data[i];
+    }
+
+    NumaTopology topology;
+    ReadNumaTopology(topology);
+
+    // on a single node the scheduler is free to move the workers
+    for (size_t i = 0; i < streams_amount; ++i) {
+        int32_t cpu = GetWorkerCpu(topology, i, streams[i].node_index);
+
+        if (topology.nodes_amount > 1) {
+            streams[i].cpu = cpu;
+        }
+    }
+
+    for (size_t i = 0; i < streams_amount; ++i) {
+        streams[i].worker = std::thread(ParseLogFile, std::cref(context), std::ref(streams[i]));
+    }
+
+    for (size_t i = 0; i < streams_amount; ++i) {
+        streams[i].batch = PopBatch(streams[i].channel);
+    }
+
+    context.nodes_amount = topology.nodes_amount;
+    context.node_throughput = new NodeThroughput[topology.nodes_amount];
+
+    for (size_t i = 0; i < topology.nodes_amount; ++i) {
+        context.node_throughput[i].node_id = topology.nodes[i].id;
+    }
+
+    FreeNumaTopology(topology);
+
+    size_t* nodes = new size_t[std::max<size_t>(streams_amount, 1)];
+    bool is_stopped = false;
+    bool is_failed = false;
+
+    for (size_t i = 0; i < streams_amount; ++i) {
+        is_failed |= IsStreamFailed(streams[i]);
+    }
+
+    if (streams_amount > 0) {
+        nodes[0] = BuildLoserTree(nodes, streams, streams_amount, 1);
+    }
+
+    // the merged rows are analyzed in batches, the same way as the rows of a single file
+    ColumnBatch* merged = new ColumnBatch;
+
+    while (!is_failed && streams_amount > 0 && GetStreamKey(streams[nodes[0]]) != UINT64_MAX) {
+        FileStream& stream = streams[nodes[0]];
+
+        if (IsColumnBatchFull(*merged)) {
+            if (!AnalyzeColumnBatch(context, *merged)) {
+                is_stopped = true;
+                break;
+            }
+
+            merged->size = 0;
+            merged->text_size = 0;
+        }
+
+        AppendRow(*merged, *stream.batch, stream.position);
+
+        AdvanceStream(stream);
+
+        if (IsStreamFailed(stream)) {
+            is_failed = true;
+            break;
+        }
+
+        ReplayLoserTree(nodes, streams, streams_amount);
+    }
+
+    is_stopped |= is_failed;
+
+    if (!is_stopped && !AnalyzeColumnBatch(context, *merged)) {
+        is_stopped = true;
+    }
+
+    delete merged;
+
+    for (size_t i = 0; i < streams_amount; ++i) {
+        if (is_stopped) {
+            CancelChannel(streams[i].channel);
+        }
+
+        streams[i].worker.join();
+
+        while (streams[i].batch != nullptr) {
+            delete streams[i].batch;
+            streams[i].batch = PopBatch(streams[i].channel);
+        }
+
+        AddFileCounters(context, streams[i].counters);
+
+        NodeThroughput& throughput = context.node_throughput[streams[i].node_index];
+        ++throughput.files_amount;
+        throughput.lines_amount += streams[i].counters.lines_analyzed;
+        throughput.bytes_read += streams[i].counters.bytes_read;
+        throughput.busy_seconds = std::max(throughput.busy_seconds, streams[i].counters.busy_seconds);
+    }
+
+    delete[] nodes;
+    delete[] streams;
+
+    if (is_failed) {
+        return "Not enough memory to read the input files";
+    }
+
+    return std::nullopt;
+}
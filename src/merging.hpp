@@ -0,0 +1,32 @@
+#pragma once
+
+#include "analyzing.hpp"
+#include "batching.hpp"
+#include "numa.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+const size_t kChannelCapacity = 4;
+const size_t kWorkerReadBufferSize = kHugePageSize;
+
+// bounded single-producer single-consumer queue of batches
+struct BatchChannel {
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    ColumnBatch* batches[kChannelCapacity] = {};
+    size_t begin = 0;
+    size_t size = 0;
+
+    bool is_finished = false;
+    // set together with is_finished when the worker could not allocate its buffers
+    bool is_failed = false;
+    std::atomic<bool> is_cancelled = false;
+};
+
+bool ReadFileTimeRange(const char* filename, uint64_t& first_timestamp, uint64_t& last_timestamp);
+
+std::optional<const char*> AnalyzeLogFiles(AnalysisContext& context);
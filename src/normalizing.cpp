@@ -0,0 +1,127 @@
+#include "normalizing.hpp"
+
+#include <cstring>
+
+const char* kIdPlaceholder = "{id}";
+const size_t kIdPlaceholderLength = 4;
+
+bool IsNormalizationEnabled(const NormalizationRules& rules) {
+    return rules.need_strip_query || rules.need_replace_ids || rules.need_drop_method;
+}
+
+bool IsSegmentEnd(char c) {
+    return c == '/' || c == '?' || c == '#';
+}
+
+// finds the path of "<method> <path> <protocol>", a request without spaces is the path itself
+void FindPath(const DynamicString& request, size_t& begin, size_t& end) {
+    const char* first_space = static_cast<const char*>(std::memchr(request.data, ' ', request.size));
+    const char* last_space = static_cast<const char*>(memrchr(request.data, ' ', request.size));
+
+    begin = 0;
+    end = request.size;
+
+    if (first_space == nullptr) {
+        return;
+    }
+
+    begin = first_space - request.data + 1;
+
+    if (last_space != first_space) {
+        end = last_space - request.data;
+    }
+}
+
+// returns the length of the numeric segment starting at position or 0 if the segment is not a number
+size_t GetNumericSegmentLength(const char* data, size_t position, size_t end) {
+    if (position == 0 || data[position - 1] != '/') {
+        return 0;
+    }
+
+    size_t length = 0;
+
+    while (position + length < end && data[position + length] >= '0' && data[position + length] <= '9') {
+        ++length;
+    }
+
+    if (position + length < end && !IsSegmentEnd(data[position + length])) {
+        return 0;
+    }
+
+    return length;
+}
+
+void ReplaceIds(DynamicString& request, size_t begin, size_t end) {
+    size_t new_size = request.size;
+    bool has_ids = false;
+
+    for (size_t i = begin; i < end; ++i) {
+        size_t length = GetNumericSegmentLength(request.data, i, end);
+
+        if (length > 0) {
+            new_size = new_size - length + kIdPlaceholderLength;
+            has_ids = true;
+            i += length;
+        }
+    }
+
+    if (!has_ids) {
+        return;
+    }
+
+    // the result is assembled after the original in the same buffer and then moved to its beginning
+    ReserveString(request, request.size + new_size + 1);
+
+    char* data = request.data;
+    char* result = data + request.size;
+
+    std::memcpy(result, data, begin);
+    size_t result_size = begin;
+
+    for (size_t i = begin; i < request.size;) {
+        size_t length = (i < end ? GetNumericSegmentLength(data, i, end) : 0);
+
+        if (length > 0) {
+            std::memcpy(result + result_size, kIdPlaceholder, kIdPlaceholderLength);
+            result_size += kIdPlaceholderLength;
+            i += length;
+        } else {
+            result[result_size++] = data[i++];
+        }
+    }
+
+    std::memmove(data, result, result_size);
+    data[result_size] = '\0';
+    request.size = result_size;
+}
+
+void NormalizeRequest(DynamicString& request, const NormalizationRules& rules) {
+    size_t begin;
+    size_t end;
+    FindPath(request, begin, end);
+
+    if (rules.need_drop_method) {
+        std::memmove(request.data, request.data + begin, end - begin);
+        request.size = end - begin;
+        request.data[request.size] = '\0';
+
+        end -= begin;
+        begin = 0;
+    }
+
+    if (rules.need_strip_query) {
+        const char* query = static_cast<const char*>(std::memchr(request.data + begin, '?', end - begin));
+
+        if (query != nullptr) {
+            size_t query_length = request.data + end - query;
+
+            std::memmove(request.data + (query - request.data), request.data + end, request.size - end + 1);
+            request.size -= query_length;
+            end -= query_length;
+        }
+    }
+
+    if (rules.need_replace_ids) {
+        ReplaceIds(request, begin, end);
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "dynamic_arrays.hpp"
+
+// rules which collapse requests differing only in details into one statistics key
+struct NormalizationRules {
+    bool need_strip_query = false;
+    bool need_replace_ids = false;
+    bool need_drop_method = false;
+};
+
+bool IsNormalizationEnabled(const NormalizationRules& rules);
+
+// rewrites the request inside its own buffer, e.g. "GET /users/42/?page=2 HTTP/1.0" -> "/users/{id}/"
+void NormalizeRequest(DynamicString& request, const NormalizationRules& rules);
@@ -0,0 +1,195 @@
+#include "numa.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <string>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+const char* kNodesDirectory = "/sys/devices/system/node";
+const char* kNodeDirectoryPrefix = "node";
+
+bool IsCpuAllowed(const cpu_set_t& allowed, int32_t cpu) {
+    return cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed);
+}
+
+void AddCpu(NumaNode& node, int32_t cpu) {
+    int32_t* new_cpus = new int32_t[node.cpus_amount + 1];
+
+    if (node.cpus != nullptr) {
+        std::copy(node.cpus, node.cpus + node.cpus_amount, new_cpus);
+        delete[] node.cpus;
+    }
+
+    new_cpus[node.cpus_amount++] = cpu;
+    node.cpus = new_cpus;
+}
+
+// cpulist format: "0-3,8-11"
+void ReadCpuList(NumaNode& node, const std::filesystem::path& path, const cpu_set_t& allowed) {
+    std::ifstream input_file(path);
+    char list[4096] = {};
+    input_file.getline(list, sizeof(list));
+
+    for (char* range = list; *range != '\0';) {
+        char* end;
+        long first = std::strtol(range, &end, 10);
+        long last = first;
+
+        if (end == range) {
+            break;
+        }
+
+        if (*end == '-') {
+            range = end + 1;
+            last = std::strtol(range, &end, 10);
+        }
+
+        for (long cpu = first; cpu <= last; ++cpu) {
+            if (IsCpuAllowed(allowed, cpu)) {
+                AddCpu(node, cpu);
+            }
+        }
+
+        range = (*end == ',' ? end + 1 : end);
+    }
+}
+
+void AddNode(NumaTopology& topology, const NumaNode& node) {
+    NumaNode* new_nodes = new NumaNode[topology.nodes_amount + 1];
+
+    if (topology.nodes != nullptr) {
+        std::copy(topology.nodes, topology.nodes + topology.nodes_amount, new_nodes);
+        delete[] topology.nodes;
+    }
+
+    new_nodes[topology.nodes_amount++] = node;
+    topology.nodes = new_nodes;
+}
+
+void ReadNumaTopology(NumaTopology& topology) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        for (int32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            CPU_SET(cpu, &allowed);
+        }
+    }
+
+    std::error_code error;
+
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(kNodesDirectory, error)) {
+        std::string name = entry.path().filename().string();
+
+        if (name.rfind(kNodeDirectoryPrefix, 0) != 0 || name.size() == std::strlen(kNodeDirectoryPrefix)
+            || !std::all_of(name.begin() + std::strlen(kNodeDirectoryPrefix), name.end(), [](char c) { return c >= '0' && c <= '9'; }))
+        {
+            continue;
+        }
+
+        NumaNode node;
+        node.id = std::atoi(name.c_str() + std::strlen(kNodeDirectoryPrefix));
+        ReadCpuList(node, entry.path() / "cpulist", allowed);
+
+        // memory-only nodes and nodes outside of the affinity mask get no workers
+        if (node.cpus_amount == 0) {
+            continue;
+        }
+
+        AddNode(topology, node);
+    }
+
+    std::sort(topology.nodes, topology.nodes + topology.nodes_amount, [](const NumaNode& lhs, const NumaNode& rhs) {
+        return lhs.id < rhs.id;
+    });
+
+    if (topology.nodes_amount == 0) {
+        NumaNode node;
+
+        for (int32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                AddCpu(node, cpu);
+            }
+        }
+
+        AddNode(topology, node);
+    }
+}
+
+void FreeNumaTopology(NumaTopology& topology) {
+    for (size_t i = 0; i < topology.nodes_amount; ++i) {
+        if (topology.nodes[i].cpus != nullptr) {
+            delete[] topology.nodes[i].cpus;
+        }
+    }
+
+    if (topology.nodes != nullptr) {
+        delete[] topology.nodes;
+    }
+
+    topology = NumaTopology{};
+}
+
+int32_t GetWorkerCpu(const NumaTopology& topology, size_t worker_index, size_t& node_index) {
+    node_index = worker_index % topology.nodes_amount;
+    const NumaNode& node = topology.nodes[node_index];
+
+    if (node.cpus_amount == 0) {
+        return -1;
+    }
+
+    return node.cpus[(worker_index / topology.nodes_amount) % node.cpus_amount];
+}
+
+bool PinCurrentThread(int32_t cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+void* AllocateLargeBuffer(size_t size) {
+    if (size < kHugePageSize) {
+        void* buffer = std::malloc(size);
+
+        if (buffer == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        return buffer;
+    }
+
+    size_t aligned_size = (size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    void* buffer = std::aligned_alloc(kHugePageSize, aligned_size);
+
+    if (buffer == nullptr) {
+        buffer = std::malloc(size);
+
+        if (buffer == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        return buffer;
+    }
+
+    // only a hint: without transparent huge pages the buffer stays on usual pages
+    madvise(buffer, aligned_size, MADV_HUGEPAGE);
+
+    return buffer;
+}
+
+void FreeLargeBuffer(void* buffer) {
+    std::free(buffer);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+const size_t kHugePageSize = 2 * 1024 * 1024;
+
+struct NumaNode {
+    int32_t id = 0;
+
+    // only the cpus the process is allowed to run on
+    int32_t* cpus = nullptr;
+    size_t cpus_amount = 0;
+};
+
+// a machine without NUMA information is described by a single node with all allowed cpus
+struct NumaTopology {
+    NumaNode* nodes = nullptr;
+    size_t nodes_amount = 0;
+};
+
+// work done by the file workers placed on one node
+struct NodeThroughput {
+    int32_t node_id = 0;
+
+    uint64_t files_amount = 0;
+    uint64_t lines_amount = 0;
+    uint64_t bytes_read = 0;
+
+    // the workers of a node run in parallel, so the node is busy as long as its slowest worker
+    double busy_seconds = 0;
+};
+
+void ReadNumaTopology(NumaTopology& topology);
+
+void FreeNumaTopology(NumaTopology& topology);
+
+// the cpu for the worker with the given index: workers go to the nodes in turn and to the cpus of a node in turn
+int32_t GetWorkerCpu(const NumaTopology& topology, size_t worker_index, size_t& node_index);
+
+bool PinCurrentThread(int32_t cpu);
+
+// buffers of at least a huge page are aligned to it and marked for transparent huge pages, smaller ones are usual,
+// throws std::bad_alloc if there is no memory
+void* AllocateLargeBuffer(size_t size);
+
+void FreeLargeBuffer(void* buffer);
@@ -0,0 +1,109 @@
+#include "parsing.hpp"
+#include "datetime.hpp"
+#include "swar.hpp"
+
+#include <cstring>
+#include <optional>
+
+std::optional<size_t> FindSubstring(const char* haystack, const char* needle, size_t start_from = 0) {
+    const char* search_result = std::strstr(haystack + start_from, needle);
+    if (search_result == nullptr) {
+        return std::nullopt;
+    }
+
+    return search_result - haystack;
+}
+
+void FreeLogEntry(LogEntry& entry) {
+    if (entry.remote_addr.data != nullptr) {
+        delete[] entry.remote_addr.data;
+    }
+
+    if (entry.request.data != nullptr) {
+        delete[] entry.request.data;
+    }
+
+    if (entry.status.data != nullptr) {
+        delete[] entry.status.data;
+    }
+
+    entry = LogEntry{};
+}
+
+bool ParseLogEntry(LogEntry& to, const char* raw_entry) {
+    return SplitLogEntry(to, raw_entry) && ParseLogEntryTimestamp(to);
+}
+
+bool ParseLogEntryTimestamp(LogEntry& entry) {
+    std::optional<uint64_t> timestamp = LocalTimeStringToTimestamp(entry.local_time);
+    if (!timestamp.has_value()) {
+        return false;
+    }
+
+    entry.timestamp = timestamp.value();
+
+    return entry.timestamp != 0;
+}
+
+bool SplitLogEntry(LogEntry& to, const char* raw_entry) {
+    std::optional<size_t> remote_addr_length = FindSubstring(raw_entry, " - - ");
+
+    if (!remote_addr_length.has_value()) {
+        return false;
+    }
+
+    SetString(to.remote_addr, raw_entry, remote_addr_length.value());
+
+    size_t local_time_start = remote_addr_length.value() + std::strlen(" - - ");
+    std::optional<size_t> local_time_end = FindSubstring(raw_entry, "]", local_time_start);
+
+    if (raw_entry[local_time_start] != '[' || !local_time_end.has_value()) {
+        return false;
+    }
+
+    size_t local_time_length = local_time_end.value() - local_time_start - 1;
+    to.local_time = std::string_view(raw_entry + local_time_start + 1, local_time_length);
+
+    size_t request_start = local_time_end.value() + 2;
+    std::optional<size_t> request_end = FindSubstring(raw_entry, "\"", request_start + 1);
+    
+    if (raw_entry[request_start] != '"' || raw_entry[request_start - 1] != ' ' || !request_end.has_value()) {
+        return false;
+    }
+
+    SetString(to.request, raw_entry + request_start + 1, (request_end.value() - request_start - 1));
+
+    size_t status_start = request_end.value() + 2;
+    std::optional<size_t> status_end = FindSubstring(raw_entry, " ", status_start);
+    
+    if (raw_entry[status_start - 1] != ' ' || !status_end.has_value() || status_end.value() - status_start != 3) {
+        return false;
+    }
+
+    SetString(to.status, raw_entry + status_start, (status_end.value() - status_start));
+
+    if (!ParseThreeDigits(to.status.data).has_value()) {
+        return false;
+    }
+
+    size_t bytes_sent_start = status_end.value() + 1;
+
+    if (raw_entry[bytes_sent_start - 1] != ' ') {
+        return false;
+    }
+
+    size_t bytes_sent_length = std::strlen(raw_entry + bytes_sent_start);
+
+    if (bytes_sent_length == 1 && raw_entry[bytes_sent_start] == '-') {
+        to.bytes_sent = 0;
+    } else {
+        std::optional<int64_t> bytes_sent = ParseBoundedInt(raw_entry + bytes_sent_start, bytes_sent_length);
+        if (!bytes_sent.has_value()) {
+            return false;
+        }
+
+        to.bytes_sent = bytes_sent.value();
+    }
+
+    return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "dynamic_string.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+struct LogEntry {
+    DynamicString remote_addr;
+    DynamicString request;
+    DynamicString status;
+
+    std::string_view local_time;
+    
+    uint64_t timestamp = 0;
+    int64_t bytes_sent = -1;
+};
+
+void FreeLogEntry(LogEntry& entry);
+
+bool ParseLogEntry(LogEntry& to, const char* raw_entry);
+
+bool SplitLogEntry(LogEntry& to, const char* raw_entry);
+
+bool ParseLogEntryTimestamp(LogEntry& entry);
@@ -0,0 +1,84 @@
+#include "sampling.hpp"
+
+#include <cmath>
+
+const uint64_t kSampleSeed = 0x9E3779B97F4A7C15ULL;
+
+uint64_t MixBits(uint64_t value) {
+    // splitmix64 finalizer: a cheap stateless hash, so the same blocks are picked on every run
+    value += kSampleSeed;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+bool IsBlockSampled(uint64_t block_index, double rate) {
+    if (rate >= 1.0) {
+        return true;
+    }
+
+    return static_cast<double>(MixBits(block_index) >> 11) * 0x1.0p-53 < rate;
+}
+
+void AddSampledBlock(SampleAccumulator& sample, uint64_t lines_amount, uint64_t errors_amount) {
+    ++sample.sampled_blocks_amount;
+
+    sample.lines_sum += lines_amount;
+    sample.lines_squares_sum += static_cast<double>(lines_amount) * lines_amount;
+    sample.errors_sum += errors_amount;
+    sample.errors_squares_sum += static_cast<double>(errors_amount) * errors_amount;
+}
+
+double GetSampleScale(const SampleAccumulator& sample) {
+    if (sample.sampled_blocks_amount == 0) {
+        return 0;
+    }
+
+    return static_cast<double>(sample.blocks_amount) / sample.sampled_blocks_amount;
+}
+
+double GetFinitePopulationCorrection(const SampleAccumulator& sample) {
+    if (sample.blocks_amount == 0) {
+        return 0;
+    }
+
+    return 1.0 - static_cast<double>(sample.sampled_blocks_amount) / sample.blocks_amount;
+}
+
+Estimate EstimateTotal(const SampleAccumulator& sample, double sum, double squares_sum) {
+    // blocks are the sampling units: total = N * mean, Var = N^2 * (1 - n/N) * s^2 / n
+    Estimate estimate;
+
+    uint64_t n = sample.sampled_blocks_amount;
+    if (n == 0) {
+        return estimate;
+    }
+
+    double mean = sum / n;
+    estimate.value = mean * sample.blocks_amount;
+
+    if (n < 2) {
+        return estimate;
+    }
+
+    double variance = (squares_sum - n * mean * mean) / (n - 1);
+    if (variance < 0) {
+        variance = 0;
+    }
+
+    double blocks_amount = static_cast<double>(sample.blocks_amount);
+    estimate.margin = kConfidenceZScore * blocks_amount * std::sqrt(GetFinitePopulationCorrection(sample) * variance / n);
+
+    return estimate;
+}
+
+Estimate EstimateCount(const SampleAccumulator& sample, uint64_t sampled_count) {
+    // per-request counts are not tracked per block, so the binomial approximation is used
+    Estimate estimate;
+
+    double scale = GetSampleScale(sample);
+    estimate.value = sampled_count * scale;
+    estimate.margin = kConfidenceZScore * scale * std::sqrt(sampled_count * GetFinitePopulationCorrection(sample));
+
+    return estimate;
+}
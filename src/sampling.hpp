@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+const uint64_t kSampleBlockSize = 64 * 1024;
+
+// z-score of the two-sided 95% confidence interval
+const double kConfidenceZScore = 1.96;
+
+struct SampleAccumulator {
+    uint64_t blocks_amount = 0;
+    uint64_t sampled_blocks_amount = 0;
+
+    double lines_sum = 0;
+    double lines_squares_sum = 0;
+    double errors_sum = 0;
+    double errors_squares_sum = 0;
+};
+
+struct Estimate {
+    double value = 0;
+    double margin = 0;
+};
+
+bool IsBlockSampled(uint64_t block_index, double rate);
+
+void AddSampledBlock(SampleAccumulator& sample, uint64_t lines_amount, uint64_t errors_amount);
+
+double GetSampleScale(const SampleAccumulator& sample);
+
+Estimate EstimateTotal(const SampleAccumulator& sample, double sum, double squares_sum);
+
+Estimate EstimateCount(const SampleAccumulator& sample, uint64_t sampled_count);
@@ -0,0 +1,713 @@
+#include "serving.hpp"
+#include "analyzing.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// read by the follower and the accepting threads, so it has to be atomic rather than sig_atomic_t
+std::atomic<bool> is_stop_requested = false;
+
+void RequestStop(int) {
+    is_stop_requested = true;
+}
+
+void AddRow(LogColumns& columns, uint64_t timestamp, int64_t bytes_sent, uint16_t status, uint32_t request_id) {
+    if (columns.size == columns.capacity) {
+        size_t new_capacity = (columns.capacity == 0 ? 1024 : columns.capacity * 2);
+
+        uint64_t* new_timestamps = new uint64_t[new_capacity];
+        int64_t* new_bytes_sent = new int64_t[new_capacity];
+        uint16_t* new_statuses = new uint16_t[new_capacity];
+        uint32_t* new_request_ids = new uint32_t[new_capacity];
+
+        if (columns.timestamps != nullptr) {
+            std::copy(columns.timestamps, columns.timestamps + columns.size, new_timestamps);
+            std::copy(columns.bytes_sent, columns.bytes_sent + columns.size, new_bytes_sent);
+            std::copy(columns.statuses, columns.statuses + columns.size, new_statuses);
+            std::copy(columns.request_ids, columns.request_ids + columns.size, new_request_ids);
+
+            delete[] columns.timestamps;
+            delete[] columns.bytes_sent;
+            delete[] columns.statuses;
+            delete[] columns.request_ids;
+        }
+
+        columns.timestamps = new_timestamps;
+        columns.bytes_sent = new_bytes_sent;
+        columns.statuses = new_statuses;
+        columns.request_ids = new_request_ids;
+        columns.capacity = new_capacity;
+    }
+
+    if (columns.size > 0 && columns.timestamps[columns.size - 1] > timestamp) {
+        columns.is_sorted = false;
+    }
+
+    columns.timestamps[columns.size] = timestamp;
+    columns.bytes_sent[columns.size] = bytes_sent;
+    columns.statuses[columns.size] = status;
+    columns.request_ids[columns.size] = request_id;
+    ++columns.size;
+}
+
+void FreeLogColumns(LogColumns& columns) {
+    if (columns.timestamps != nullptr) {
+        delete[] columns.timestamps;
+        delete[] columns.bytes_sent;
+        delete[] columns.statuses;
+        delete[] columns.request_ids;
+    }
+
+    FreeStringDictionary(columns.requests);
+
+    columns = LogColumns{};
+}
+
+void AddLine(ServerState& state, LogEntry& entry, const char* line) {
+    LogColumns& columns = state.columns;
+
+    LineClass line_class = ClassifyLine(state.filter, entry, line, false);
+
+    if (line_class == LineClass::kFiltered) {
+        ++columns.filtered_lines_amount;
+        return;
+    } else if (line_class == LineClass::kInvalid) {
+        ++columns.invalid_lines_amount;
+        return;
+    }
+
+    uint16_t status = (entry.status.data[0] - '0') * 100 + (entry.status.data[1] - '0') * 10 + (entry.status.data[2] - '0');
+    uint32_t request_id = kNoStringId;
+
+    if (entry.status.data[0] == '5') {
+        if (IsNormalizationEnabled(state.parameters->normalization_rules)) {
+            NormalizeRequest(entry.request, state.parameters->normalization_rules);
+        }
+
+        request_id = InternString(columns.requests, std::string_view(entry.request.data, entry.request.size));
+    }
+
+    AddRow(columns, entry.timestamp, entry.bytes_sent, status, request_id);
+}
+
+// reads the complete lines appended since the last call; a line without '\n' at the end of a followed file
+// may still be being written, so it is left for the next call
+bool LoadNewLines(ServerState& state, FollowedFile& file, char* line_buffer, LogEntry& entry, size_t max_lines_amount) {
+    std::ifstream& input_file = file.input_file;
+    bool is_followed = state.parameters->need_follow;
+
+    input_file.clear();
+    input_file.seekg(file.position);
+
+    for (size_t i = 0; i < max_lines_amount; ++i) {
+        input_file.getline(line_buffer, kLineBufferSize);
+        uint64_t line_length = input_file.gcount();
+
+        if (input_file.eof()) {
+            if (!is_followed && line_length > 0) {
+                file.position += line_length;
+                ++state.columns.lines_loaded;
+                AddLine(state, entry, line_buffer);
+            }
+
+            return false;
+        }
+
+        if (input_file.fail()) {
+            input_file.clear();
+            input_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            line_length += input_file.gcount();
+
+            if (input_file.eof() && is_followed) {
+                return false;
+            }
+
+            file.position += line_length;
+
+            ++state.columns.lines_loaded;
+            ++state.columns.too_long_lines_amount;
+            continue;
+        }
+
+        file.position += line_length;
+
+        ++state.columns.lines_loaded;
+        AddLine(state, entry, line_buffer);
+    }
+
+    return true;
+}
+
+void FollowFiles(ServerState& state) {
+    char* line_buffer = new char[kLineBufferSize];
+    LogEntry entry;
+
+    while (!is_stop_requested) {
+        for (size_t i = 0; i < state.files_amount; ++i) {
+            bool has_more = true;
+
+            while (has_more && !is_stop_requested) {
+                std::unique_lock lock(state.mutex);
+                has_more = LoadNewLines(state, state.files[i], line_buffer, entry, kFollowBatchLinesAmount);
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(kFollowIntervalMs));
+    }
+
+    FreeLogEntry(entry);
+    delete[] line_buffer;
+}
+
+struct ResponseWriter {
+    int socket = -1;
+    char* buffer = nullptr;
+    size_t size = 0;
+    bool is_failed = false;
+};
+
+void FlushResponse(ResponseWriter& writer) {
+    size_t sent = 0;
+
+    while (sent < writer.size && !writer.is_failed) {
+        ssize_t result = send(writer.socket, writer.buffer + sent, writer.size - sent, MSG_NOSIGNAL);
+
+        if (result <= 0) {
+            writer.is_failed = true;
+            break;
+        }
+
+        sent += result;
+    }
+
+    writer.size = 0;
+}
+
+void WriteResponse(ResponseWriter& writer, const char* text, size_t length) {
+    while (length > 0) {
+        if (writer.size == kServerBufferSize) {
+            FlushResponse(writer);
+        }
+
+        size_t part = std::min(length, kServerBufferSize - writer.size);
+        std::memcpy(writer.buffer + writer.size, text, part);
+
+        writer.size += part;
+        text += part;
+        length -= part;
+    }
+}
+
+void WriteResponse(ResponseWriter& writer, const char* text) {
+    WriteResponse(writer, text, std::strlen(text));
+}
+
+// rows with timestamps in [from, to] are [begin, end) when the columns are sorted,
+// otherwise the whole columns are scanned and every row is checked
+void GetRowsRange(const LogColumns& columns, uint64_t from, uint64_t to, size_t& begin, size_t& end) {
+    if (!columns.is_sorted) {
+        begin = 0;
+        end = columns.size;
+        return;
+    }
+
+    begin = std::lower_bound(columns.timestamps, columns.timestamps + columns.size, from) - columns.timestamps;
+    end = std::upper_bound(columns.timestamps, columns.timestamps + columns.size, to) - columns.timestamps;
+}
+
+void AnswerRange(ServerState& state, ResponseWriter& writer, uint64_t from, uint64_t to) {
+    const LogColumns& columns = state.columns;
+
+    size_t begin;
+    size_t end;
+    GetRowsRange(columns, from, to, begin, end);
+
+    uint64_t lines_amount = 0;
+    uint64_t server_errors_amount = 0;
+    uint64_t bytes_sent = 0;
+
+    for (size_t i = begin; i < end; ++i) {
+        if (columns.timestamps[i] < from || columns.timestamps[i] > to) {
+            continue;
+        }
+
+        ++lines_amount;
+        server_errors_amount += (columns.statuses[i] / 100 == 5 ? 1 : 0);
+        bytes_sent += std::max<int64_t>(columns.bytes_sent[i], 0);
+    }
+
+    char line[96];
+    std::snprintf(line, sizeof(line), "%" PRIu64 " %" PRIu64 " %" PRIu64 "\n", lines_amount, server_errors_amount, bytes_sent);
+    WriteResponse(writer, line);
+}
+
+void AnswerStats(ServerState& state, ResponseWriter& writer, int64_t amount, uint64_t from, uint64_t to) {
+    const LogColumns& columns = state.columns;
+
+    size_t begin;
+    size_t end;
+    GetRowsRange(columns, from, to, begin, end);
+
+    uint64_t* frequencies = new uint64_t[columns.requests.size];
+    std::fill(frequencies, frequencies + columns.requests.size, 0);
+
+    for (size_t i = begin; i < end; ++i) {
+        if (columns.request_ids[i] != kNoStringId && columns.timestamps[i] >= from && columns.timestamps[i] <= to) {
+            ++frequencies[columns.request_ids[i]];
+        }
+    }
+
+    // the requests are borrowed from the dictionary, so only the array itself is freed
+    StatsArray stats;
+
+    for (size_t id = 0; id < columns.requests.size; ++id) {
+        if (frequencies[id] > 0) {
+            RequestStatistic stat;
+            stat.request = columns.requests.strings[id];
+            stat.frequency = frequencies[id];
+            AddElement(stats, stat);
+        }
+    }
+
+    SortByFrequency(stats);
+
+    for (size_t i = 0; i < stats.size && i < static_cast<size_t>(amount); ++i) {
+        char frequency[24];
+        std::snprintf(frequency, sizeof(frequency), "%" PRIu64 " ", stats.data[i].frequency);
+
+        WriteResponse(writer, frequency);
+        WriteResponse(writer, stats.data[i].request);
+        WriteResponse(writer, "\n");
+    }
+
+    if (stats.data != nullptr) {
+        delete[] stats.data;
+    }
+
+    delete[] frequencies;
+}
+
+void AnswerWindow(ServerState& state, ResponseWriter& writer, int64_t length, uint64_t from, uint64_t to) {
+    const LogColumns& columns = state.columns;
+
+    size_t begin;
+    size_t end;
+    GetRowsRange(columns, from, to, begin, end);
+
+    uint64_t* timestamps = new uint64_t[std::max<size_t>(end - begin, 1)];
+    size_t size = 0;
+
+    for (size_t i = begin; i < end; ++i) {
+        if (columns.timestamps[i] >= from && columns.timestamps[i] <= to) {
+            timestamps[size++] = columns.timestamps[i];
+        }
+    }
+
+    if (!columns.is_sorted) {
+        std::sort(timestamps, timestamps + size);
+    }
+
+    uint64_t max_amount_of_requests = 0;
+    uint64_t lower_timestamp = 0;
+    uint64_t higher_timestamp = 0;
+
+    // two pointers: [lower, higher) are the requests of the window which starts at timestamps[lower]
+    for (size_t lower = 0, higher = 0; lower < size; ++lower) {
+        higher = std::max(higher, lower);
+
+        while (higher < size && timestamps[higher] < timestamps[lower] + length) {
+            ++higher;
+        }
+
+        if (higher - lower > max_amount_of_requests) {
+            max_amount_of_requests = higher - lower;
+            lower_timestamp = timestamps[lower];
+            higher_timestamp = std::min(timestamps[lower] + length - 1, timestamps[size - 1]);
+        }
+    }
+
+    delete[] timestamps;
+
+    char line[96];
+    std::snprintf(line, sizeof(line), "%" PRIu64 " %" PRIu64 " %" PRIu64 "\n", lower_timestamp, higher_timestamp, max_amount_of_requests);
+    WriteResponse(writer, line);
+}
+
+void AnswerInfo(ServerState& state, ResponseWriter& writer) {
+    const LogColumns& columns = state.columns;
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "%" PRIu64 " %zu %" PRIu64 " %" PRIu64 " %" PRIu64 "\n",
+                  columns.lines_loaded, columns.size, columns.invalid_lines_amount,
+                  columns.filtered_lines_amount, columns.too_long_lines_amount);
+    WriteResponse(writer, line);
+}
+
+size_t SplitTokens(char* query, char** tokens) {
+    size_t tokens_amount = 0;
+
+    char* save_pointer = nullptr;
+
+    // strtok_r, as clients are served by several threads at once
+    for (char* token = strtok_r(query, " \t\r", &save_pointer); token != nullptr; token = strtok_r(nullptr, " \t\r", &save_pointer)) {
+        if (tokens_amount == kMaxQueryTokens) {
+            return kMaxQueryTokens + 1;
+        }
+
+        tokens[tokens_amount++] = token;
+    }
+
+    return tokens_amount;
+}
+
+// returns the error message for a wrong query
+std::optional<const char*> AnswerQuery(ServerState& state, ResponseWriter& writer, char* query) {
+    char* tokens[kMaxQueryTokens];
+    size_t tokens_amount = SplitTokens(query, tokens);
+
+    if (tokens_amount == 0 || tokens_amount > kMaxQueryTokens) {
+        return "Wrong amount of arguments";
+    }
+
+    int64_t numbers[kMaxQueryTokens] = {};
+
+    for (size_t i = 1; i < tokens_amount; ++i) {
+        std::expected<int64_t, const char*> number = ParseInt(tokens[i]);
+        if (!number.has_value() || number.value() < 0) {
+            return "Arguments must be non-negative integers";
+        }
+
+        numbers[i] = number.value();
+    }
+
+    std::shared_lock lock(state.mutex);
+
+    if (std::strcmp(tokens[0], "INFO") == 0 && tokens_amount == 1) {
+        AnswerInfo(state, writer);
+    } else if (std::strcmp(tokens[0], "RANGE") == 0 && tokens_amount == 3) {
+        AnswerRange(state, writer, numbers[1], numbers[2] == 0 ? UINT64_MAX : numbers[2]);
+    } else if (std::strcmp(tokens[0], "STATS") == 0 && (tokens_amount == 2 || tokens_amount == 4)) {
+        AnswerStats(state, writer, numbers[1], numbers[2], numbers[3] == 0 ? UINT64_MAX : numbers[3]);
+    } else if (std::strcmp(tokens[0], "WINDOW") == 0 && (tokens_amount == 2 || tokens_amount == 4) && numbers[1] > 0) {
+        AnswerWindow(state, writer, numbers[1], numbers[2], numbers[3] == 0 ? UINT64_MAX : numbers[3]);
+    } else {
+        return "Unknown query";
+    }
+
+    return std::nullopt;
+}
+
+void ServeClient(ServerState& state, ClientConnection* connection) {
+    int client_socket = connection->socket;
+
+    ResponseWriter writer;
+    writer.socket = client_socket;
+    writer.buffer = new char[kServerBufferSize];
+
+    char* query = new char[kServerBufferSize];
+    size_t query_size = 0;
+    bool is_quit = false;
+
+    while (!writer.is_failed && !is_quit) {
+        ssize_t received = recv(client_socket, query + query_size, kServerBufferSize - query_size - 1, 0);
+        if (received <= 0) {
+            break;
+        }
+
+        query_size += received;
+
+        char* line_begin = query;
+        char* line_end;
+
+        while ((line_end = static_cast<char*>(std::memchr(line_begin, '\n', query + query_size - line_begin))) != nullptr) {
+            *line_end = '\0';
+
+            // the answers to the queries before QUIT are still sent
+            if (std::strcmp(line_begin, "QUIT") == 0) {
+                is_quit = true;
+                break;
+            }
+
+            std::optional<const char*> error = AnswerQuery(state, writer, line_begin);
+
+            if (error.has_value()) {
+                WriteResponse(writer, "ERROR ");
+                WriteResponse(writer, error.value());
+                WriteResponse(writer, "\n");
+            }
+
+            WriteResponse(writer, "END\n");
+            line_begin = line_end + 1;
+        }
+
+        FlushResponse(writer);
+
+        query_size -= line_begin - query;
+        std::memmove(query, line_begin, query_size);
+
+        if (query_size == kServerBufferSize - 1) {
+            break;
+        }
+    }
+
+    delete[] query;
+    delete[] writer.buffer;
+
+    // the client sees the end of the stream now, the descriptor itself is closed after the join
+    shutdown(client_socket, SHUT_RDWR);
+
+    std::lock_guard lock(state.clients_mutex);
+    connection->is_finished = true;
+}
+
+void FreeClient(ClientConnection* connection) {
+    connection->thread.join();
+    close(connection->socket);
+    delete connection;
+}
+
+// joins the clients which have already disconnected, so they do not pile up in a long running server
+void RemoveFinishedClients(ServerState& state) {
+    std::lock_guard lock(state.clients_mutex);
+
+    for (size_t i = 0; i < state.clients_amount;) {
+        if (!state.clients[i]->is_finished) {
+            ++i;
+            continue;
+        }
+
+        FreeClient(state.clients[i]);
+        state.clients[i] = state.clients[state.clients_amount - 1];
+        --state.clients_amount;
+    }
+}
+
+void AddClient(ServerState& state, int client_socket) {
+    ClientConnection* connection = new ClientConnection;
+    connection->socket = client_socket;
+
+    std::lock_guard lock(state.clients_mutex);
+
+    if (state.clients_amount == state.clients_capacity) {
+        size_t new_capacity = (state.clients_capacity == 0 ? 16 : state.clients_capacity * 2);
+        ClientConnection** new_clients = new ClientConnection*[new_capacity];
+
+        if (state.clients != nullptr) {
+            std::copy(state.clients, state.clients + state.clients_amount, new_clients);
+            delete[] state.clients;
+        }
+
+        state.clients = new_clients;
+        state.clients_capacity = new_capacity;
+    }
+
+    state.clients[state.clients_amount] = connection;
+    ++state.clients_amount;
+
+    connection->thread = std::thread(ServeClient, std::ref(state), connection);
+}
+
+void DisconnectClients(ServerState& state) {
+    {
+        std::lock_guard lock(state.clients_mutex);
+
+        for (size_t i = 0; i < state.clients_amount; ++i) {
+            shutdown(state.clients[i]->socket, SHUT_RDWR);
+        }
+    }
+
+    // only this thread changes the array, the client threads take the mutex just to mark themselves finished
+    for (size_t i = 0; i < state.clients_amount; ++i) {
+        FreeClient(state.clients[i]);
+    }
+
+    state.clients_amount = 0;
+
+    if (state.clients != nullptr) {
+        delete[] state.clients;
+    }
+}
+
+// a socket file left by a server which is not running anymore refuses connections
+bool IsStaleSocket(const sockaddr_un& address) {
+    int probe_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe_socket == -1) {
+        return false;
+    }
+
+    bool is_stale = connect(probe_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1 && errno == ECONNREFUSED;
+    close(probe_socket);
+
+    return is_stale;
+}
+
+// only a stale socket is replaced, any other file at the path is kept
+std::optional<const char*> RemoveStaleSocket(const sockaddr_un& address) {
+    struct stat status;
+
+    if (lstat(address.sun_path, &status) == -1) {
+        if (errno == ENOENT) {
+            return std::nullopt;
+        }
+
+        return "Unable to check the socket path";
+    }
+
+    if (!S_ISSOCK(status.st_mode) || !IsStaleSocket(address)) {
+        return "The socket path exists";
+    }
+
+    unlink(address.sun_path);
+    return std::nullopt;
+}
+
+// the socket file is removed only if it is still the one bound by this process
+void RemoveBoundSocket(const char* path, const struct stat& bound_status) {
+    struct stat status;
+
+    if (lstat(path, &status) == 0 && S_ISSOCK(status.st_mode)
+        && status.st_dev == bound_status.st_dev && status.st_ino == bound_status.st_ino) {
+        unlink(path);
+    }
+}
+
+std::optional<const char*> ListenOnSocket(const char* path, int& server_socket, struct stat& bound_status) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (std::strlen(path) >= sizeof(address.sun_path)) {
+        return "The socket path is too long";
+    }
+
+    std::strcpy(address.sun_path, path);
+
+    server_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_socket == -1) {
+        return "Unable to create the socket";
+    }
+
+    std::optional<const char*> removing_error = RemoveStaleSocket(address);
+
+    if (removing_error.has_value()) {
+        close(server_socket);
+        return removing_error;
+    }
+
+    if (bind(server_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1) {
+        close(server_socket);
+        return "Unable to listen on the socket";
+    }
+
+    if (lstat(path, &bound_status) == -1 || listen(server_socket, SOMAXCONN) == -1) {
+        close(server_socket);
+        unlink(path);
+        return "Unable to listen on the socket";
+    }
+
+    return std::nullopt;
+}
+
+std::optional<const char*> ServeLog(const Parameters& parameters) {
+    ServerState state;
+    state.parameters = &parameters;
+
+    state.files_amount = parameters.logs_filenames.size;
+    state.files = new FollowedFile[state.files_amount];
+
+    for (size_t i = 0; i < state.files_amount; ++i) {
+        state.files[i].input_file.open(parameters.logs_filenames.data[i]);
+
+        if (state.files[i].input_file.fail()) {
+            delete[] state.files;
+            return "Unable to read the input file";
+        }
+    }
+
+    BuildLogFilter(state.filter, parameters.filter_patterns);
+
+    char* line_buffer = new char[kLineBufferSize];
+    LogEntry entry;
+
+    for (size_t i = 0; i < state.files_amount; ++i) {
+        while (LoadNewLines(state, state.files[i], line_buffer, entry, SIZE_MAX)) {}
+    }
+
+    FreeLogEntry(entry);
+    delete[] line_buffer;
+
+    std::cout << "Loaded " << state.columns.size << " entries (" << state.columns.requests.size << " distinct 5XX requests), "
+              << state.columns.invalid_lines_amount << " lines were invalid" << std::endl;
+
+    int server_socket;
+    struct stat bound_status;
+    std::optional<const char*> listening_error = ListenOnSocket(parameters.serve_path, server_socket, bound_status);
+
+    if (listening_error.has_value()) {
+        FreeLogFilter(state.filter);
+        FreeLogColumns(state.columns);
+        delete[] state.files;
+        return listening_error;
+    }
+
+    // the server stops on a signal to remove the socket file
+    struct sigaction action{};
+    action.sa_handler = RequestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    std::cout << "Listening on " << parameters.serve_path << std::endl;
+
+    std::thread follower;
+    if (parameters.need_follow) {
+        follower = std::thread(FollowFiles, std::ref(state));
+    }
+
+    pollfd server_poll{};
+    server_poll.fd = server_socket;
+    server_poll.events = POLLIN;
+
+    // the signal may be delivered to any thread, so accept() is not relied on to be interrupted
+    while (!is_stop_requested) {
+        if (poll(&server_poll, 1, kFollowIntervalMs) <= 0) {
+            continue;
+        }
+
+        int client_socket = accept(server_socket, nullptr, nullptr);
+
+        if (client_socket == -1) {
+            continue;
+        }
+
+        RemoveFinishedClients(state);
+        AddClient(state, client_socket);
+    }
+
+    close(server_socket);
+    RemoveBoundSocket(parameters.serve_path, bound_status);
+
+    DisconnectClients(state);
+
+    if (follower.joinable()) {
+        follower.join();
+    }
+
+    FreeLogFilter(state.filter);
+    FreeLogColumns(state.columns);
+    delete[] state.files;
+
+    return std::nullopt;
+}
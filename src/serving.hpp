@@ -0,0 +1,73 @@
+#pragma once
+
+#include "argparsing.hpp"
+#include "filtering.hpp"
+#include "interning.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+
+const size_t kServerBufferSize = 64 * 1024;
+const size_t kFollowBatchLinesAmount = 4096;
+const int32_t kFollowIntervalMs = 200;
+const int32_t kMaxQueryTokens = 4;
+
+// the log kept in memory column by column, requests are stored only for the 5XX lines
+struct LogColumns {
+    uint64_t* timestamps = nullptr;
+    int64_t* bytes_sent = nullptr;
+    uint16_t* statuses = nullptr;
+    uint32_t* request_ids = nullptr;
+
+    size_t size = 0;
+    size_t capacity = 0;
+
+    // range queries use a binary search while the timestamps are ordered
+    bool is_sorted = true;
+
+    StringDictionary requests;
+
+    uint64_t lines_loaded = 0;
+    uint64_t invalid_lines_amount = 0;
+    uint64_t filtered_lines_amount = 0;
+    uint64_t too_long_lines_amount = 0;
+};
+
+struct FollowedFile {
+    std::ifstream input_file;
+    uint64_t position = 0;
+};
+
+struct ClientConnection {
+    int socket = -1;
+    std::thread thread;
+
+    // set by the client thread under the clients mutex right before it exits
+    bool is_finished = false;
+};
+
+struct ServerState {
+    const Parameters* parameters = nullptr;
+
+    LogFilter filter;
+    LogColumns columns;
+
+    FollowedFile* files = nullptr;
+    size_t files_amount = 0;
+
+    // readers take it shared, loading of the appended lines takes it exclusively
+    std::shared_mutex mutex;
+
+    // the connections are owned by the accepting thread, which joins them, the sockets are closed after the join
+    std::mutex clients_mutex;
+    ClientConnection** clients = nullptr;
+    size_t clients_capacity = 0;
+    size_t clients_amount = 0;
+};
+
+std::optional<const char*> ServeLog(const Parameters& parameters);
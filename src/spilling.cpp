@@ -0,0 +1,276 @@
+#include "spilling.hpp"
+#include "analyzing.hpp"
+
+#include <cstring>
+#include <cinttypes>
+#include <utility>
+
+struct RunCursor {
+    std::FILE* file = nullptr;
+    char* request = nullptr;
+    uint64_t frequency = 0;
+};
+
+void AddRun(SpillRuns& runs, std::FILE* file) {
+    if (runs.size == runs.capacity) {
+        if (runs.capacity == 0) {
+            runs.capacity = 1;
+        }
+
+        std::FILE** new_data = new std::FILE*[runs.capacity * 2];
+        runs.capacity *= 2;
+
+        for (size_t i = 0; i < runs.size; ++i) {
+            new_data[i] = runs.data[i];
+        }
+
+        if (runs.data != nullptr) {
+            delete[] runs.data;
+        }
+
+        runs.data = new_data;
+    }
+
+    runs.data[runs.size] = file;
+    ++runs.size;
+}
+
+bool ReadRunEntry(RunCursor& cursor) {
+    if (std::fgets(cursor.request, kLineBufferSize, cursor.file) == nullptr) {
+        return false;
+    }
+
+    char* separator = std::strchr(cursor.request, ' ');
+    if (separator == nullptr) {
+        return false;
+    }
+
+    cursor.frequency = std::strtoull(cursor.request, nullptr, 10);
+
+    size_t request_length = std::strlen(separator + 1);
+    if (request_length > 0 && separator[request_length] == '\n') {
+        --request_length;
+    }
+
+    std::memmove(cursor.request, separator + 1, request_length);
+    cursor.request[request_length] = '\0';
+
+    return true;
+}
+
+// heap of cursors ordered by their current request, the smallest one on top
+void SiftDown(RunCursor* heap, size_t size, size_t index) {
+    while (2 * index + 1 < size) {
+        size_t child = 2 * index + 1;
+
+        if (child + 1 < size && std::strcmp(heap[child + 1].request, heap[child].request) < 0) {
+            ++child;
+        }
+
+        if (std::strcmp(heap[index].request, heap[child].request) <= 0) {
+            break;
+        }
+
+        std::swap(heap[index], heap[child]);
+        index = child;
+    }
+}
+
+// heap of the most frequent requests, the least frequent one on top
+void SiftDownByFrequency(RequestStatistic* heap, size_t size, size_t index) {
+    while (2 * index + 1 < size) {
+        size_t child = 2 * index + 1;
+
+        if (child + 1 < size && heap[child + 1].frequency < heap[child].frequency) {
+            ++child;
+        }
+
+        if (heap[index].frequency <= heap[child].frequency) {
+            break;
+        }
+
+        std::swap(heap[index], heap[child]);
+        index = child;
+    }
+}
+
+void SiftUpByFrequency(RequestStatistic* heap, size_t index) {
+    while (index > 0 && heap[(index - 1) / 2].frequency > heap[index].frequency) {
+        std::swap(heap[(index - 1) / 2], heap[index]);
+        index = (index - 1) / 2;
+    }
+}
+
+void OfferToTop(StatsArray& top, int32_t amount, const char* request, uint64_t frequency) {
+    if (top.size == static_cast<size_t>(amount) && top.data[0].frequency >= frequency) {
+        return;
+    }
+
+    RequestStatistic stat;
+    stat.frequency = frequency;
+    stat.request = new char[std::strlen(request) + 1];
+    std::strcpy(stat.request, request);
+
+    if (top.size < static_cast<size_t>(amount)) {
+        AddElement(top, stat);
+        top.strings_memory += std::strlen(request) + 1;
+        SiftUpByFrequency(top.data, top.size - 1);
+        return;
+    }
+
+    top.strings_memory += std::strlen(request) + 1;
+    top.strings_memory -= std::strlen(top.data[0].request) + 1;
+    delete[] top.data[0].request;
+
+    top.data[0] = stat;
+    SiftDownByFrequency(top.data, top.size, 0);
+}
+
+// merged requests go either to a new run or to the top of the most frequent ones
+struct MergeOutput {
+    std::FILE* file = nullptr;
+
+    StatsArray* top = nullptr;
+    int32_t amount = 0;
+};
+
+void EmitMergedRequest(MergeOutput& output, const char* request, uint64_t frequency) {
+    if (output.file != nullptr) {
+        std::fprintf(output.file, "%" PRIu64 " %s\n", frequency, request);
+    } else {
+        OfferToTop(*output.top, output.amount, request, frequency);
+    }
+}
+
+bool MergeFiles(std::FILE** files, size_t files_amount, MergeOutput& output) {
+    RunCursor* heap = new RunCursor[files_amount];
+    size_t heap_size = 0;
+
+    for (size_t i = 0; i < files_amount; ++i) {
+        std::rewind(files[i]);
+
+        RunCursor cursor;
+        cursor.file = files[i];
+        cursor.request = new char[kLineBufferSize];
+
+        if (ReadRunEntry(cursor)) {
+            heap[heap_size++] = cursor;
+        } else {
+            delete[] cursor.request;
+        }
+    }
+
+    for (size_t i = heap_size; i > 0; --i) {
+        SiftDown(heap, heap_size, i - 1);
+    }
+
+    char* current_request = new char[kLineBufferSize];
+    uint64_t current_frequency = 0;
+    bool has_current = false;
+
+    while (heap_size > 0) {
+        RunCursor& cursor = heap[0];
+
+        if (has_current && std::strcmp(current_request, cursor.request) == 0) {
+            current_frequency += cursor.frequency;
+        } else {
+            if (has_current) {
+                EmitMergedRequest(output, current_request, current_frequency);
+            }
+
+            std::strcpy(current_request, cursor.request);
+            current_frequency = cursor.frequency;
+            has_current = true;
+        }
+
+        if (!ReadRunEntry(cursor)) {
+            delete[] cursor.request;
+            heap[0] = heap[--heap_size];
+        }
+
+        SiftDown(heap, heap_size, 0);
+    }
+
+    if (has_current) {
+        EmitMergedRequest(output, current_request, current_frequency);
+    }
+
+    bool is_failed = false;
+    for (size_t i = 0; i < files_amount; ++i) {
+        is_failed |= std::ferror(files[i]) != 0;
+    }
+
+    delete[] current_request;
+    delete[] heap;
+
+    return !is_failed;
+}
+
+// replaces all the runs with one merged run, so the amount of open temporary files stays bounded
+bool CompactRuns(SpillRuns& runs) {
+    std::FILE* file = std::tmpfile();
+    if (file == nullptr) {
+        return false;
+    }
+
+    MergeOutput output;
+    output.file = file;
+
+    bool is_merged = MergeFiles(runs.data, runs.size, output);
+
+    for (size_t i = 0; i < runs.size; ++i) {
+        std::fclose(runs.data[i]);
+    }
+
+    runs.data[0] = file;
+    runs.size = 1;
+
+    return is_merged && std::fflush(file) == 0 && std::ferror(file) == 0;
+}
+
+bool SpillStatistics(SpillRuns& runs, StatsArray& statistics) {
+    if (statistics.size == 0) {
+        return true;
+    }
+
+    // a merged run is not longer than the amount of distinct requests, so merging in passes keeps the results exact
+    if (runs.size == kMaxOpenRuns && !CompactRuns(runs)) {
+        return false;
+    }
+
+    std::FILE* file = std::tmpfile();
+    if (file == nullptr) {
+        return false;
+    }
+
+    AddRun(runs, file);
+    SortByRequest(statistics);
+
+    for (size_t i = 0; i < statistics.size; ++i) {
+        std::fprintf(file, "%" PRIu64 " %s\n", statistics.data[i].frequency, statistics.data[i].request);
+    }
+
+    ClearStatistics(statistics);
+
+    return std::fflush(file) == 0 && std::ferror(file) == 0;
+}
+
+bool MergeRuns(SpillRuns& runs, StatsArray& top, int32_t amount) {
+    MergeOutput output;
+    output.top = &top;
+    output.amount = amount;
+
+    return MergeFiles(runs.data, runs.size, output);
+}
+
+void FreeSpillRuns(SpillRuns& runs) {
+    for (size_t i = 0; i < runs.size; ++i) {
+        std::fclose(runs.data[i]);
+    }
+
+    if (runs.data != nullptr) {
+        delete[] runs.data;
+    }
+
+    runs = SpillRuns{};
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "dynamic_arrays.hpp"
+
+#include <cstdint>
+#include <cstdio>
+
+// runs are merged into one when there are this many, so the file descriptor limit is never reached
+const size_t kMaxOpenRuns = 64;
+
+// temporary files with runs of the frequency table, each sorted by request
+struct SpillRuns {
+    size_t capacity = 0;
+    size_t size = 0;
+    std::FILE** data = nullptr;
+};
+
+bool SpillStatistics(SpillRuns& runs, StatsArray& statistics);
+
+bool MergeRuns(SpillRuns& runs, StatsArray& top, int32_t amount);
+
+void FreeSpillRuns(SpillRuns& runs);
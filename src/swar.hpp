@@ -0,0 +1,125 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+// Fixed-width decimal parsers working on several digits at once inside one integer (SWAR).
+// They are defined here so that the line parser can inline them.
+
+// checks that every byte of the word (in the bytes selected by the mask) is an ASCII digit
+inline bool AreDigits(uint32_t word, uint32_t mask) {
+    return (word & (0xF0F0F0F0u & mask)) == (0x30303030u & mask)
+        && ((word + 0x06060606u) & (0xF0F0F0F0u & mask)) == (0x30303030u & mask);
+}
+
+// converts four digit bytes into two 2-digit numbers: the first pair in the low half, the second one in the high half
+inline uint32_t CombineDigitPairs(uint32_t word) {
+    word -= 0x30303030u;
+    return (word & 0x000F000Fu) * 10 + ((word & 0x0F000F00u) >> 8);
+}
+
+inline uint32_t LoadWord(const char* str) {
+    uint32_t word;
+    std::memcpy(&word, str, sizeof(word));
+
+    if constexpr (std::endian::native == std::endian::big) {
+        word = __builtin_bswap32(word);
+    }
+
+    return word;
+}
+
+inline std::optional<uint32_t> ParseTwoDigits(const char* str) {
+    uint32_t word = static_cast<uint8_t>(str[0]) | (static_cast<uint32_t>(static_cast<uint8_t>(str[1])) << 8);
+
+    if (!AreDigits(word, 0x0000FFFFu)) {
+        return std::nullopt;
+    }
+
+    return CombineDigitPairs(word | 0x30300000u) & 0xFFFFu;
+}
+
+inline std::optional<uint32_t> ParseFourDigits(const char* str) {
+    uint32_t word = LoadWord(str);
+
+    if (!AreDigits(word, 0xFFFFFFFFu)) {
+        return std::nullopt;
+    }
+
+    uint32_t pairs = CombineDigitPairs(word);
+    return (pairs & 0xFFFFu) * 100 + (pairs >> 16);
+}
+
+inline std::optional<uint32_t> ParseThreeDigits(const char* str) {
+    // the number is padded with a leading zero to reuse the four digits conversion
+    uint32_t word = 0x30u
+                  | (static_cast<uint32_t>(static_cast<uint8_t>(str[0])) << 8)
+                  | (static_cast<uint32_t>(static_cast<uint8_t>(str[1])) << 16)
+                  | (static_cast<uint32_t>(static_cast<uint8_t>(str[2])) << 24);
+
+    if (!AreDigits(word, 0xFFFFFFFFu)) {
+        return std::nullopt;
+    }
+
+    uint32_t pairs = CombineDigitPairs(word);
+    return (pairs & 0xFFFFu) * 100 + (pairs >> 16);
+}
+
+// parses a "+hhmm" or "-hhmm" timezone into a shift in seconds (the sign is returned separately)
+inline std::optional<uint32_t> ParseTimezoneShift(const char* str) {
+    if (str[0] != '+' && str[0] != '-') {
+        return std::nullopt;
+    }
+
+    uint32_t word = LoadWord(str + 1);
+
+    if (!AreDigits(word, 0xFFFFFFFFu)) {
+        return std::nullopt;
+    }
+
+    uint32_t pairs = CombineDigitPairs(word);
+    return (pairs & 0xFFFFu) * 60 * 60 + (pairs >> 16) * 60;
+}
+
+// same result as ParseInt for a string of the given length, but without std::from_chars and std::expected
+inline std::optional<int64_t> ParseBoundedInt(const char* str, size_t length) {
+    const char* end = str + length;
+    bool is_negative = false;
+
+    if (str != end && *str == '-') {
+        is_negative = true;
+        ++str;
+    }
+
+    if (str == end) {
+        return std::nullopt;
+    }
+
+    while (end - str > 1 && *str == '0') {
+        ++str;
+    }
+
+    // 19 digits always fit into uint64_t, the int64_t range is checked after
+    if (end - str > 19) {
+        return std::nullopt;
+    }
+
+    uint64_t result = 0;
+
+    for (; str != end; ++str) {
+        uint32_t digit = static_cast<uint8_t>(*str) - '0';
+        if (digit > 9) {
+            return std::nullopt;
+        }
+
+        result = result * 10 + digit;
+    }
+
+    if (result > static_cast<uint64_t>(INT64_MAX) + (is_negative ? 1 : 0)) {
+        return std::nullopt;
+    }
+
+    return is_negative ? static_cast<int64_t>(0 - result) : static_cast<int64_t>(result);
+}
@@ -0,0 +1,458 @@
+#include "window.hpp"
+
+#include <algorithm>
+#include <utility>
+
+void InitWindow(WindowState& window, uint32_t length, double alert_rate) {
+    window.length = length;
+    window.alert_rate = alert_rate;
+
+    window.amount_of_requests_in_second = new uint32_t[length];
+    std::fill(window.amount_of_requests_in_second, window.amount_of_requests_in_second + length, 0);
+
+    window.amount_of_server_errors_in_second = new uint32_t[length];
+    std::fill(window.amount_of_server_errors_in_second, window.amount_of_server_errors_in_second + length, 0);
+}
+
+double GetErrorRate(const WindowResult& result) {
+    return result.amount_of_requests == 0 ? 0 : static_cast<double>(result.amount_of_server_errors) / result.amount_of_requests;
+}
+
+void AddAlert(WindowState& window, uint64_t lower_timestamp, uint64_t higher_timestamp, double error_rate) {
+    // windows are checked in chronological order, so an overlapping one can only continue the last interval
+    if (window.alerts_amount > 0 && window.alerts[window.alerts_amount - 1].higher_timestamp >= lower_timestamp) {
+        AlertInterval& last = window.alerts[window.alerts_amount - 1];
+
+        last.higher_timestamp = std::max(last.higher_timestamp, higher_timestamp);
+        last.max_error_rate = std::max(last.max_error_rate, error_rate);
+        return;
+    }
+
+    if (window.alerts_amount == window.alerts_capacity) {
+        size_t new_capacity = (window.alerts_capacity == 0 ? 16 : window.alerts_capacity * 2);
+        AlertInterval* new_alerts = new AlertInterval[new_capacity];
+
+        if (window.alerts != nullptr) {
+            std::copy(window.alerts, window.alerts + window.alerts_amount, new_alerts);
+            delete[] window.alerts;
+        }
+
+        window.alerts = new_alerts;
+        window.alerts_capacity = new_capacity;
+    }
+
+    AlertInterval& alert = window.alerts[window.alerts_amount++];
+    alert.lower_timestamp = lower_timestamp;
+    alert.higher_timestamp = higher_timestamp;
+    alert.max_error_rate = error_rate;
+}
+
+// called for every window which ends at a second with requests, before it slides further
+void SaveWindowIfMax(WindowState& window) {
+    if (window.current_amount_of_requests > window.max_amount_of_requests) {
+        window.max_amount_of_requests = window.current_amount_of_requests;
+        window.result_higher_timestamp = window.higher_timestamp;
+        window.result_lower_timestamp = window.lower_timestamp;
+    }
+
+    WindowResult current;
+    current.lower_timestamp = window.lower_timestamp;
+    current.higher_timestamp = window.higher_timestamp;
+    current.amount_of_requests = window.current_amount_of_requests;
+    current.amount_of_server_errors = window.current_amount_of_server_errors;
+
+    if (current.amount_of_server_errors > window.max_server_errors_window.amount_of_server_errors) {
+        window.max_server_errors_window = current;
+    }
+
+    // compared by cross-multiplication, the busier window wins a tie
+    uint64_t lhs = static_cast<uint64_t>(current.amount_of_server_errors) * window.max_error_rate_window.amount_of_requests;
+    uint64_t rhs = static_cast<uint64_t>(window.max_error_rate_window.amount_of_server_errors) * current.amount_of_requests;
+
+    if (current.amount_of_server_errors > 0 && (lhs > rhs || (lhs == rhs && current.amount_of_requests > window.max_error_rate_window.amount_of_requests))) {
+        window.max_error_rate_window = current;
+    }
+
+    double error_rate = GetErrorRate(current);
+
+    if (window.alert_rate > 0 && error_rate > window.alert_rate) {
+        AddAlert(window, current.lower_timestamp, current.higher_timestamp, error_rate);
+    }
+}
+
+void UpdateWindow(WindowState& window, uint64_t timestamp, bool is_server_error) {
+    if (window.lower_timestamp == 0) {
+        window.lower_timestamp = timestamp;
+        window.higher_timestamp = window.lower_timestamp + window.length - 1;
+    }
+
+    if (timestamp < window.lower_timestamp) {
+        ++window.late_entries_amount;
+        return;
+    }
+
+    uint32_t second;
+
+    if (timestamp <= window.higher_timestamp) {
+        second = (window.array_offset + timestamp - window.lower_timestamp) % window.length;
+    } else {
+        SaveWindowIfMax(window);
+        
+        window.higher_timestamp = timestamp;
+
+        // after a gap longer than the window every second leaves it, so the ring is cleared at once
+        if (window.lower_timestamp + 2 * window.length <= window.higher_timestamp) {
+            std::fill(window.amount_of_requests_in_second, window.amount_of_requests_in_second + window.length, 0);
+            std::fill(window.amount_of_server_errors_in_second, window.amount_of_server_errors_in_second + window.length, 0);
+
+            window.current_amount_of_requests = 0;
+            window.current_amount_of_server_errors = 0;
+
+            window.array_offset = 0;
+            window.lower_timestamp = window.higher_timestamp - window.length + 1;
+        }
+
+        while (window.lower_timestamp + window.length <= window.higher_timestamp) {
+            window.current_amount_of_requests -= window.amount_of_requests_in_second[window.array_offset % window.length];
+            window.amount_of_requests_in_second[window.array_offset % window.length] = 0;
+
+            window.current_amount_of_server_errors -= window.amount_of_server_errors_in_second[window.array_offset % window.length];
+            window.amount_of_server_errors_in_second[window.array_offset % window.length] = 0;
+
+            ++window.array_offset;
+            ++window.lower_timestamp;
+        }
+
+        second = (window.array_offset + window.length - 1) % window.length;
+    }
+
+    ++window.amount_of_requests_in_second[second];
+    ++window.current_amount_of_requests;
+
+    if (is_server_error) {
+        ++window.amount_of_server_errors_in_second[second];
+        ++window.current_amount_of_server_errors;
+    }
+}
+
+void FinishWindow(WindowState& window, uint64_t last_timestamp) {
+    SaveWindowIfMax(window);
+
+    window.result_higher_timestamp = std::min(window.result_higher_timestamp, last_timestamp);
+    window.max_server_errors_window.higher_timestamp = std::min(window.max_server_errors_window.higher_timestamp, last_timestamp);
+    window.max_error_rate_window.higher_timestamp = std::min(window.max_error_rate_window.higher_timestamp, last_timestamp);
+
+    if (window.alerts_amount > 0) {
+        AlertInterval& last = window.alerts[window.alerts_amount - 1];
+        last.higher_timestamp = std::min(last.higher_timestamp, last_timestamp);
+    }
+}
+
+void FreeWindow(WindowState& window) {
+    if (window.amount_of_requests_in_second != nullptr) {
+        delete[] window.amount_of_requests_in_second;
+        delete[] window.amount_of_server_errors_in_second;
+    }
+
+    if (window.alerts != nullptr) {
+        delete[] window.alerts;
+    }
+
+    window = WindowState{};
+}
+
+// index of the first chunk with a number not less than chunk_id
+size_t FindSecondsChunk(const SecondCounts& counts, uint64_t chunk_id) {
+    return std::lower_bound(counts.chunk_ids, counts.chunk_ids + counts.chunks_amount, chunk_id) - counts.chunk_ids;
+}
+
+void InsertSecondsChunk(SecondCounts& counts, size_t index, uint64_t chunk_id) {
+    if (counts.chunks_amount == counts.chunks_capacity) {
+        size_t new_capacity = std::max<size_t>(counts.chunks_capacity * 2, 16);
+        uint64_t* new_chunk_ids = new uint64_t[new_capacity];
+        uint32_t** new_chunks = new uint32_t*[new_capacity];
+
+        if (counts.chunks != nullptr) {
+            std::copy(counts.chunk_ids, counts.chunk_ids + counts.chunks_amount, new_chunk_ids);
+            std::copy(counts.chunks, counts.chunks + counts.chunks_amount, new_chunks);
+            delete[] counts.chunk_ids;
+            delete[] counts.chunks;
+        }
+
+        counts.chunk_ids = new_chunk_ids;
+        counts.chunks = new_chunks;
+        counts.chunks_capacity = new_capacity;
+    }
+
+    std::copy_backward(counts.chunk_ids + index, counts.chunk_ids + counts.chunks_amount, counts.chunk_ids + counts.chunks_amount + 1);
+    std::copy_backward(counts.chunks + index, counts.chunks + counts.chunks_amount, counts.chunks + counts.chunks_amount + 1);
+    ++counts.chunks_amount;
+
+    counts.chunk_ids[index] = chunk_id;
+    counts.chunks[index] = new uint32_t[kSecondsInChunk];
+    std::fill(counts.chunks[index], counts.chunks[index] + kSecondsInChunk, 0);
+}
+
+void AddToSecondCounts(SecondCounts& counts, uint64_t timestamp) {
+    uint64_t chunk_id = timestamp / kSecondsInChunk;
+    size_t index = counts.last_index;
+
+    if (index >= counts.chunks_amount || counts.chunk_ids[index] != chunk_id) {
+        index = FindSecondsChunk(counts, chunk_id);
+
+        if (index == counts.chunks_amount || counts.chunk_ids[index] != chunk_id) {
+            InsertSecondsChunk(counts, index, chunk_id);
+        }
+
+        counts.last_index = index;
+    }
+
+    ++counts.chunks[index][timestamp % kSecondsInChunk];
+
+    counts.first_timestamp = std::min(counts.first_timestamp, timestamp);
+    counts.last_timestamp = std::max(counts.last_timestamp, timestamp);
+}
+
+// the seconds are read in order, so hint keeps the index of the chunk found by the previous call
+uint32_t GetSecondCount(const SecondCounts& counts, uint64_t timestamp, size_t& hint) {
+    uint64_t chunk_id = timestamp / kSecondsInChunk;
+
+    if (hint >= counts.chunks_amount || counts.chunk_ids[hint] != chunk_id) {
+        hint = FindSecondsChunk(counts, chunk_id);
+
+        if (hint == counts.chunks_amount || counts.chunk_ids[hint] != chunk_id) {
+            return 0;
+        }
+    }
+
+    return counts.chunks[hint][timestamp % kSecondsInChunk];
+}
+
+// a window is worse when it has fewer requests or, with the same amount, starts later
+bool IsWorseWindow(const WindowResult& lhs, const WindowResult& rhs) {
+    return lhs.amount_of_requests < rhs.amount_of_requests
+        || (lhs.amount_of_requests == rhs.amount_of_requests && lhs.lower_timestamp > rhs.lower_timestamp);
+}
+
+// heap of the best windows, the worst one on top
+void SiftDownWindow(WindowResult* heap, size_t size, size_t index) {
+    while (2 * index + 1 < size) {
+        size_t child = 2 * index + 1;
+
+        if (child + 1 < size && IsWorseWindow(heap[child + 1], heap[child])) {
+            ++child;
+        }
+
+        if (!IsWorseWindow(heap[child], heap[index])) {
+            break;
+        }
+
+        std::swap(heap[index], heap[child]);
+        index = child;
+    }
+}
+
+void SiftUpWindow(WindowResult* heap, size_t index) {
+    while (index > 0 && IsWorseWindow(heap[index], heap[(index - 1) / 2])) {
+        std::swap(heap[(index - 1) / 2], heap[index]);
+        index = (index - 1) / 2;
+    }
+}
+
+void GrowWindows(WindowResult*& windows, size_t amount, size_t& capacity, size_t limit) {
+    size_t new_capacity = std::min(std::max<size_t>(capacity * 2, 16), limit);
+    WindowResult* new_windows = new WindowResult[new_capacity];
+
+    if (windows != nullptr) {
+        std::copy(windows, windows + amount, new_windows);
+        delete[] windows;
+    }
+
+    windows = new_windows;
+    capacity = new_capacity;
+}
+
+size_t FindTopWindows(const SecondCounts& counts, uint32_t length, size_t amount, WindowResult*& results) {
+    results = nullptr;
+
+    if (counts.chunks == nullptr || amount == 0) {
+        return 0;
+    }
+
+    // every chosen window overlaps at most 2 * length - 1 windows, including itself, so the k-th greedy choice
+    // is among the best (k - 1) * (2 * length - 1) + 1 windows and only that many candidates are kept,
+    // but never more than there are starts in the range; the heap grows with the seconds with requests,
+    // so the bound is only reached on a busy range
+    uint64_t seconds_amount = counts.last_timestamp - counts.first_timestamp + 1;
+    size_t candidates_limit = std::min<uint64_t>(amount * (2 * static_cast<uint64_t>(length) - 1), seconds_amount);
+    WindowResult* candidates = nullptr;
+    size_t candidates_amount = 0;
+    size_t candidates_capacity = 0;
+
+    uint64_t last_second = counts.chunk_ids[counts.chunks_amount - 1] * kSecondsInChunk + kSecondsInChunk - 1;
+    uint64_t amount_of_requests = 0;
+
+    size_t lower_hint = 0;
+    size_t higher_hint = 0;
+
+    // the window [lower, lower + length - 1] is slid over every start from the first request to the last one
+    for (uint64_t second = counts.first_timestamp; second < counts.first_timestamp + length - 1 && second <= last_second; ++second) {
+        amount_of_requests += GetSecondCount(counts, second, higher_hint);
+    }
+
+    for (uint64_t lower = counts.first_timestamp; lower <= counts.last_timestamp; ++lower) {
+        uint64_t higher = lower + length - 1;
+
+        if (higher <= last_second) {
+            amount_of_requests += GetSecondCount(counts, higher, higher_hint);
+        }
+
+        uint32_t lower_amount = GetSecondCount(counts, lower, lower_hint);
+
+        // a window can always be moved right to its first request without losing any, so only such starts are compared
+        if (lower_amount > 0) {
+            WindowResult window;
+            window.lower_timestamp = lower;
+            window.higher_timestamp = std::min(higher, counts.last_timestamp);
+            window.amount_of_requests = amount_of_requests;
+
+            if (candidates_amount < candidates_limit) {
+                if (candidates_amount == candidates_capacity) {
+                    GrowWindows(candidates, candidates_amount, candidates_capacity, candidates_limit);
+                }
+
+                candidates[candidates_amount] = window;
+                SiftUpWindow(candidates, candidates_amount++);
+            } else if (IsWorseWindow(candidates[0], window)) {
+                candidates[0] = window;
+                SiftDownWindow(candidates, candidates_amount, 0);
+            }
+        }
+
+        amount_of_requests -= lower_amount;
+
+        // the rest of an empty window lies before the next second to add, so if that second is in an unallocated chunk,
+        // every window ending before the next allocated chunk is empty and their starts are skipped
+        uint64_t next_second = lower + length;
+
+        if (amount_of_requests == 0 && next_second <= last_second) {
+            uint64_t next_chunk_id = next_second / kSecondsInChunk;
+            size_t next_index = FindSecondsChunk(counts, next_chunk_id);
+
+            if (counts.chunk_ids[next_index] != next_chunk_id) {
+                lower = std::max(lower, counts.chunk_ids[next_index] * kSecondsInChunk - length);
+            }
+        }
+    }
+
+    std::sort(candidates, candidates + candidates_amount, [](const WindowResult& lhs, const WindowResult& rhs) {
+        return IsWorseWindow(rhs, lhs);
+    });
+
+    // the chosen windows are moved to the front of the candidates, which become the results
+    size_t results_amount = 0;
+
+    for (size_t i = 0; i < candidates_amount && results_amount < amount; ++i) {
+        bool is_overlapping = false;
+
+        for (size_t j = 0; j < results_amount && !is_overlapping; ++j) {
+            is_overlapping = candidates[i].lower_timestamp < candidates[j].lower_timestamp + length
+                          && candidates[j].lower_timestamp < candidates[i].lower_timestamp + length;
+        }
+
+        if (!is_overlapping) {
+            candidates[results_amount++] = candidates[i];
+        }
+    }
+
+    results = candidates;
+
+    return results_amount;
+}
+
+void FreeSecondCounts(SecondCounts& counts) {
+    for (size_t i = 0; i < counts.chunks_amount; ++i) {
+        delete[] counts.chunks[i];
+    }
+
+    if (counts.chunks != nullptr) {
+        delete[] counts.chunk_ids;
+        delete[] counts.chunks;
+    }
+
+    counts = SecondCounts{};
+}
+
+void PushTimestamp(ReorderBuffer& buffer, uint64_t timestamp, bool is_server_error) {
+    if (buffer.size == buffer.capacity) {
+        if (buffer.capacity == 0) {
+            buffer.capacity = 1;
+        }
+
+        uint64_t* new_data = new uint64_t[buffer.capacity * 2];
+        buffer.capacity *= 2;
+
+        std::copy(buffer.data, buffer.data + buffer.size, new_data);
+
+        if (buffer.data != nullptr) {
+            delete[] buffer.data;
+        }
+
+        buffer.data = new_data;
+    }
+
+    size_t index = buffer.size++;
+    buffer.data[index] = (timestamp << 1) | (is_server_error ? 1 : 0);
+
+    while (index > 0 && buffer.data[(index - 1) / 2] > buffer.data[index]) {
+        std::swap(buffer.data[(index - 1) / 2], buffer.data[index]);
+        index = (index - 1) / 2;
+    }
+
+    buffer.max_timestamp = std::max(buffer.max_timestamp, timestamp);
+}
+
+bool PopTimestamp(ReorderBuffer& buffer, uint64_t& timestamp, bool& is_server_error) {
+    if (buffer.size == 0) {
+        return false;
+    }
+
+    timestamp = buffer.data[0] >> 1;
+    is_server_error = (buffer.data[0] & 1) != 0;
+    buffer.data[0] = buffer.data[--buffer.size];
+
+    size_t index = 0;
+    while (2 * index + 1 < buffer.size) {
+        size_t child = 2 * index + 1;
+
+        if (child + 1 < buffer.size && buffer.data[child + 1] < buffer.data[child]) {
+            ++child;
+        }
+
+        if (buffer.data[index] <= buffer.data[child]) {
+            break;
+        }
+
+        std::swap(buffer.data[index], buffer.data[child]);
+        index = child;
+    }
+
+    return true;
+}
+
+bool PopReadyTimestamp(ReorderBuffer& buffer, uint64_t& timestamp, bool& is_server_error) {
+    // an entry is released once the newest one is more than max_skew seconds ahead of it
+    if (buffer.size == 0 || (buffer.data[0] >> 1) + buffer.max_skew >= buffer.max_timestamp) {
+        return false;
+    }
+
+    return PopTimestamp(buffer, timestamp, is_server_error);
+}
+
+void FreeReorderBuffer(ReorderBuffer& buffer) {
+    if (buffer.data != nullptr) {
+        delete[] buffer.data;
+    }
+
+    buffer = ReorderBuffer{};
+}
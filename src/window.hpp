@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct WindowResult {
+    uint64_t lower_timestamp = 0;
+    uint64_t higher_timestamp = 0;
+
+    uint32_t amount_of_requests = 0;
+    uint32_t amount_of_server_errors = 0;
+};
+
+// interval of overlapping windows in which the share of 5XX requests exceeded the alert rate
+struct AlertInterval {
+    uint64_t lower_timestamp = 0;
+    uint64_t higher_timestamp = 0;
+
+    double max_error_rate = 0;
+};
+
+// sliding window of a fixed length over the per-second ring of request counts
+struct WindowState {
+    uint32_t length = 0;
+
+    uint64_t lower_timestamp = 0;
+    uint64_t higher_timestamp = 0;
+
+    uint32_t max_amount_of_requests = 0;
+    uint32_t current_amount_of_requests = 0;
+
+    uint64_t result_lower_timestamp = 0;
+    uint64_t result_higher_timestamp = 0;
+
+    uint32_t* amount_of_requests_in_second = nullptr;
+    uint32_t array_offset = 0;
+
+    // 5XX requests are counted in a parallel ring indexed the same way
+    uint32_t* amount_of_server_errors_in_second = nullptr;
+    uint32_t current_amount_of_server_errors = 0;
+
+    WindowResult max_server_errors_window;
+    WindowResult max_error_rate_window;
+
+    // alerts are collected only when alert_rate is positive
+    double alert_rate = 0;
+    AlertInterval* alerts = nullptr;
+    size_t alerts_amount = 0;
+    size_t alerts_capacity = 0;
+
+    // entries older than the start of the current window, they cannot be counted anymore
+    uint64_t late_entries_amount = 0;
+};
+
+const uint64_t kSecondsInChunk = 1 << 16;
+
+// requests per second over the whole analyzed range, only the chunks with requests are allocated
+// and they are kept sorted by their numbers, so a stray timestamp costs one chunk and not the whole gap
+struct SecondCounts {
+    uint64_t* chunk_ids = nullptr;
+    uint32_t** chunks = nullptr;
+    size_t chunks_amount = 0;
+    size_t chunks_capacity = 0;
+
+    // chunk of the previous timestamp, the next one usually falls into it
+    size_t last_index = 0;
+
+    uint64_t first_timestamp = UINT64_MAX;
+    uint64_t last_timestamp = 0;
+};
+
+// min-heap of timestamps which holds entries back until no earlier one can arrive,
+// the 5XX flag is kept in the lowest bit of every key
+struct ReorderBuffer {
+    uint64_t* data = nullptr;
+    size_t capacity = 0;
+    size_t size = 0;
+
+    uint32_t max_skew = 0;
+    uint64_t max_timestamp = 0;
+};
+
+void InitWindow(WindowState& window, uint32_t length, double alert_rate);
+
+void UpdateWindow(WindowState& window, uint64_t timestamp, bool is_server_error);
+
+void FinishWindow(WindowState& window, uint64_t last_timestamp);
+
+void FreeWindow(WindowState& window);
+
+double GetErrorRate(const WindowResult& result);
+
+void AddToSecondCounts(SecondCounts& counts, uint64_t timestamp);
+
+// finds up to amount busiest windows which do not overlap each other, returns their number,
+// the results array is allocated here and freed by the caller
+size_t FindTopWindows(const SecondCounts& counts, uint32_t length, size_t amount, WindowResult*& results);
+
+void FreeSecondCounts(SecondCounts& counts);
+
+void PushTimestamp(ReorderBuffer& buffer, uint64_t timestamp, bool is_server_error);
+
+bool PopReadyTimestamp(ReorderBuffer& buffer, uint64_t& timestamp, bool& is_server_error);
+
+bool PopTimestamp(ReorderBuffer& buffer, uint64_t& timestamp, bool& is_server_error);
+
+void FreeReorderBuffer(ReorderBuffer& buffer);
@@ -0,0 +1,159 @@
+#include "writing.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef ANALYZELOG_HAS_ZLIB
+#include <zlib.h>
+
+// the fastest level keeps the writer ahead of the analysis, log lines compress well anyway
+const char* kGzipMode = "wb1";
+#endif
+
+BlockWriter::~BlockWriter() {
+    CloseBlockWriter(*this);
+}
+
+bool IsCompressionSupported(OutputCompression compression) {
+#ifdef ANALYZELOG_HAS_ZLIB
+    return compression == OutputCompression::kNone || compression == OutputCompression::kGzip;
+#else
+    return compression == OutputCompression::kNone;
+#endif
+}
+
+bool WriteBlock(BlockWriter& writer, const OutputBlock& block) {
+#ifdef ANALYZELOG_HAS_ZLIB
+    if (writer.compression == OutputCompression::kGzip) {
+        return gzwrite(static_cast<gzFile>(writer.gzip_file), block.data, block.size) == static_cast<int>(block.size);
+    }
+#endif
+
+    return std::fwrite(block.data, 1, block.size, writer.file) == block.size;
+}
+
+void WriteBlocks(BlockWriter& writer) {
+    while (true) {
+        OutputBlock block;
+
+        {
+            std::unique_lock lock(writer.mutex);
+            writer.changed.wait(lock, [&writer]() { return writer.size > 0 || writer.is_finished; });
+
+            if (writer.size == 0) {
+                return;
+            }
+
+            block = writer.queue[writer.begin];
+        }
+
+        // after a failure the blocks are still taken so that the analysis does not wait forever
+        bool is_written = !writer.is_failed && WriteBlock(writer, block);
+        delete[] block.data;
+
+        std::lock_guard lock(writer.mutex);
+
+        writer.begin = (writer.begin + 1) % kOutputQueueCapacity;
+        --writer.size;
+        writer.is_failed |= !is_written;
+
+        writer.changed.notify_all();
+    }
+}
+
+bool OpenBlockWriter(BlockWriter& writer, const char* path, OutputCompression compression) {
+    writer.compression = compression;
+
+#ifdef ANALYZELOG_HAS_ZLIB
+    if (compression == OutputCompression::kGzip) {
+        gzFile gzip_file = gzopen(path, kGzipMode);
+        if (gzip_file == nullptr) {
+            return false;
+        }
+
+        gzbuffer(gzip_file, kOutputBlockSize);
+        writer.gzip_file = gzip_file;
+    }
+#endif
+
+    if (compression == OutputCompression::kNone) {
+        writer.file = std::fopen(path, "wb");
+        if (writer.file == nullptr) {
+            return false;
+        }
+    }
+
+    if (writer.file == nullptr && writer.gzip_file == nullptr) {
+        return false;
+    }
+
+    writer.writer = std::thread(WriteBlocks, std::ref(writer));
+    return true;
+}
+
+void PushBlock(BlockWriter& writer) {
+    std::unique_lock lock(writer.mutex);
+    writer.changed.wait(lock, [&writer]() { return writer.size < kOutputQueueCapacity; });
+
+    writer.queue[(writer.begin + writer.size) % kOutputQueueCapacity] = writer.current;
+    ++writer.size;
+
+    writer.current = OutputBlock{};
+    writer.changed.notify_all();
+}
+
+void WriteLine(BlockWriter& writer, const char* line) {
+    size_t length = std::strlen(line);
+
+    if (writer.current.size + length + 1 > writer.current.capacity) {
+        if (writer.current.size > 0) {
+            PushBlock(writer);
+        }
+
+        if (writer.current.data == nullptr || writer.current.capacity < length + 1) {
+            delete[] writer.current.data;
+
+            writer.current.capacity = std::max(kOutputBlockSize, length + 1);
+            writer.current.data = new char[writer.current.capacity];
+        }
+    }
+
+    std::memcpy(writer.current.data + writer.current.size, line, length);
+    writer.current.data[writer.current.size + length] = '\n';
+    writer.current.size += length + 1;
+}
+
+bool CloseBlockWriter(BlockWriter& writer) {
+    if (!writer.writer.joinable()) {
+        return !writer.is_failed;
+    }
+
+    if (writer.current.size > 0) {
+        PushBlock(writer);
+    }
+
+    delete[] writer.current.data;
+    writer.current = OutputBlock{};
+
+    {
+        std::lock_guard lock(writer.mutex);
+        writer.is_finished = true;
+        writer.changed.notify_all();
+    }
+
+    writer.writer.join();
+
+#ifdef ANALYZELOG_HAS_ZLIB
+    if (writer.gzip_file != nullptr) {
+        writer.is_failed |= gzclose(static_cast<gzFile>(writer.gzip_file)) != Z_OK;
+        writer.gzip_file = nullptr;
+    }
+#endif
+
+    if (writer.file != nullptr) {
+        writer.is_failed |= std::fclose(writer.file) != 0;
+        writer.file = nullptr;
+    }
+
+    return !writer.is_failed;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+const size_t kOutputBlockSize = 256 * 1024;
+const size_t kOutputQueueCapacity = 8;
+
+enum class OutputCompression : uint8_t {
+    kNone,
+    kGzip,
+};
+
+struct OutputBlock {
+    char* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+// output file written by a background thread, the analysis only appends lines to in-memory blocks
+// and waits only when kOutputQueueCapacity full blocks are still not written
+struct BlockWriter {
+    OutputCompression compression = OutputCompression::kNone;
+
+    std::FILE* file = nullptr;
+    void* gzip_file = nullptr;
+
+    OutputBlock current;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    OutputBlock queue[kOutputQueueCapacity];
+    size_t begin = 0;
+    size_t size = 0;
+
+    bool is_finished = false;
+    bool is_failed = false;
+
+    std::thread writer;
+
+    // the writer is also closed when it goes out of scope, like the std::ofstream it replaces
+    ~BlockWriter();
+};
+
+bool IsCompressionSupported(OutputCompression compression);
+
+bool OpenBlockWriter(BlockWriter& writer, const char* path, OutputCompression compression);
+
+void WriteLine(BlockWriter& writer, const char* line);
+
+// writes the rest of the lines and waits for the writer, returns false if any write has failed
+bool CloseBlockWriter(BlockWriter& writer);
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// The parsing of the original utility, frozen here as the reference for the tests.
+// It is copied instead of linked, so that a change in src/ cannot change the reference too.
+
+inline std::expected<int64_t, const char*> BaselineParseInt(std::string_view str) {
+    int64_t result;
+    std::from_chars_result convertion_result = std::from_chars(str.data(), str.data() + str.size(), result);
+
+    if (convertion_result.ec == std::errc::invalid_argument || convertion_result.ptr != str.end()) {
+        return std::unexpected{"Cannot parse an integer from non-numeric data"};
+    } else if (convertion_result.ec == std::errc::result_out_of_range) {
+        return std::unexpected{"The number is too large"};
+    }
+
+    return result;
+}
+
+// the status had to consist of digits only
+inline bool BaselineIsNumeric(const char* str) {
+    for (size_t i = 0; i < std::strlen(str); ++i) {
+        if (!std::isdigit(str[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+constexpr const char* kBaselineMonthsList[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+constexpr int8_t kBaselineDaysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+struct BaselineDateTime {
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+    uint8_t hours;
+    uint8_t minutes;
+    uint8_t seconds;
+};
+
+inline std::optional<uint8_t> BaselineMonthToNumber(std::string_view month) {
+    for (int i = 1; i <= 12; ++i) {
+        if (month == kBaselineMonthsList[i - 1]) {
+            return i;
+        }
+    }
+
+    return std::nullopt;
+}
+
+inline bool BaselineIsLeapYear(uint16_t year) {
+    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+}
+
+inline std::optional<uint8_t> BaselineGetDaysInMonth(uint8_t month, uint16_t year) {
+    if (month == 2 && BaselineIsLeapYear(year)) {
+        return 29;
+    }
+
+    if (month > 12) {
+        return std::nullopt;
+    }
+
+    return kBaselineDaysInMonth[month - 1];
+}
+
+inline std::optional<uint64_t> BaselineDateTimeToTimestamp(const BaselineDateTime& datetime) {
+    uint64_t result = 0;
+
+    for (uint16_t year = 1970; year < datetime.year; ++year) {
+        result += (BaselineIsLeapYear(year) ? 366 : 365) * 24 * 60 * 60;
+    }
+
+    for (int8_t month = 1; month < datetime.month; ++month) {
+        std::optional<uint8_t> days_in_month = BaselineGetDaysInMonth(month, datetime.year);
+        if (!days_in_month.has_value()) {
+            return std::nullopt;
+        }
+
+        result += days_in_month.value() * 24 * 60 * 60;
+    }
+
+    result += (datetime.day - 1) * 24 * 60 * 60;
+    result += datetime.hours * 60 * 60;
+    result += datetime.minutes * 60;
+    result += datetime.seconds;
+
+    return result;
+}
+
+// reads the separators by their positions without checking the length first, so the string has to be followed
+// by the rest of a log line, as it was in the utility
+inline std::optional<uint64_t> BaselineLocalTimeStringToTimestamp(std::string_view local_time) {
+    BaselineDateTime datetime;
+
+    // format: 01/Jul/1995:00:00:01 -0400
+
+    if (local_time[2] != '/') {
+        return std::nullopt;
+    }
+
+    std::expected<int64_t, const char*> day = BaselineParseInt(local_time.substr(0, 2));
+    if (!day.has_value()) {
+        return std::nullopt;
+    }
+
+    local_time = local_time.substr(3);
+
+    if (local_time[3] != '/') {
+        return std::nullopt;
+    }
+
+    std::optional<uint8_t> month = BaselineMonthToNumber(local_time.substr(0, 3));
+    if (!month.has_value()) {
+        return std::nullopt;
+    }
+
+    local_time = local_time.substr(4);
+
+    if (local_time[4] != ':') {
+        return std::nullopt;
+    }
+
+    std::expected<int64_t, const char*> year = BaselineParseInt(local_time.substr(0, 4));
+    if (!year.has_value()) {
+        return std::nullopt;
+    }
+
+    local_time = local_time.substr(5);
+
+    if (local_time[2] != ':') {
+        return std::nullopt;
+    }
+
+    std::expected<int64_t, const char*> hours = BaselineParseInt(local_time.substr(0, 2));
+    if (!hours.has_value()) {
+        return std::nullopt;
+    }
+
+    local_time = local_time.substr(3);
+
+    if (local_time[2] != ':') {
+        return std::nullopt;
+    }
+
+    std::expected<int64_t, const char*> minutes = BaselineParseInt(local_time.substr(0, 2));
+    if (!minutes.has_value()) {
+        return std::nullopt;
+    }
+
+    local_time = local_time.substr(3);
+
+    if (local_time[2] != ' ') {
+        return std::nullopt;
+    }
+
+    std::expected<int64_t, const char*> seconds = BaselineParseInt(local_time.substr(0, 2));
+    if (!seconds.has_value()) {
+        return std::nullopt;
+    }
+
+    std::string_view timezone = local_time.substr(3);
+
+    if (timezone.length() != 5 || (timezone[0] != '+' && timezone[0] != '-')) {
+        return std::nullopt;
+    }
+
+    if (day.value() == -1
+     || month.value() == -1
+     || year.value() == -1
+     || hours.value() == -1
+     || minutes.value() == -1
+     || seconds.value() == -1)
+    {
+        return std::nullopt;
+    }
+
+    datetime.day = day.value();
+    datetime.month = month.value();
+    datetime.year = year.value();
+    datetime.hours = hours.value();
+    datetime.minutes = minutes.value();
+    datetime.seconds = seconds.value();
+
+    std::expected<int64_t, const char*> hours_shift = BaselineParseInt(timezone.substr(1, 2));
+    if (!hours_shift.has_value()) {
+        return std::nullopt;
+    }
+
+    std::expected<int64_t, const char*> minutes_shift = BaselineParseInt(timezone.substr(3, 2));
+    if (!minutes_shift.has_value()) {
+        return std::nullopt;
+    }
+
+    uint32_t seconds_shift = (hours_shift.value() * 60 * 60) + (minutes_shift.value() * 60);
+    std::optional<uint64_t> result = BaselineDateTimeToTimestamp(datetime);
+    if (!result.has_value()) {
+        return std::nullopt;
+    }
+
+    if (timezone[0] == '+') {
+        return result.value() - seconds_shift;
+    }
+
+    return result.value() + seconds_shift;
+}
+
+// the fields are kept in std::string, the original DynamicString held the same characters
+struct BaselineLogEntry {
+    std::string remote_addr;
+    std::string request;
+    std::string status;
+
+    uint64_t timestamp = 0;
+    int64_t bytes_sent = -1;
+};
+
+inline std::optional<size_t> BaselineFindSubstring(const char* haystack, const char* needle, size_t start_from = 0) {
+    const char* search_result = std::strstr(haystack + start_from, needle);
+    if (search_result == nullptr) {
+        return std::nullopt;
+    }
+
+    return search_result - haystack;
+}
+
+inline bool BaselineParseLogEntry(BaselineLogEntry& to, const char* raw_entry) {
+    std::optional<size_t> remote_addr_length = BaselineFindSubstring(raw_entry, " - - ");
+
+    if (!remote_addr_length.has_value()) {
+        return false;
+    }
+
+    to.remote_addr.assign(raw_entry, remote_addr_length.value());
+
+    size_t local_time_start = remote_addr_length.value() + std::strlen(" - - ");
+    std::optional<size_t> local_time_end = BaselineFindSubstring(raw_entry, "]", local_time_start);
+
+    if (raw_entry[local_time_start] != '[' || !local_time_end.has_value()) {
+        return false;
+    }
+
+    size_t local_time_length = local_time_end.value() - local_time_start - 1;
+    std::string_view raw_local_time = std::string_view(raw_entry + local_time_start + 1, local_time_length);
+
+    std::optional<uint64_t> timestamp = BaselineLocalTimeStringToTimestamp(raw_local_time);
+    if (!timestamp.has_value()) {
+        return false;
+    }
+
+    to.timestamp = timestamp.value();
+
+    if (to.timestamp == 0) {
+        return false;
+    }
+
+    size_t request_start = local_time_end.value() + 2;
+    std::optional<size_t> request_end = BaselineFindSubstring(raw_entry, "\"", request_start + 1);
+
+    if (raw_entry[request_start] != '"' || raw_entry[request_start - 1] != ' ' || !request_end.has_value()) {
+        return false;
+    }
+
+    to.request.assign(raw_entry + request_start + 1, (request_end.value() - request_start - 1));
+
+    size_t status_start = request_end.value() + 2;
+    std::optional<size_t> status_end = BaselineFindSubstring(raw_entry, " ", status_start);
+
+    if (raw_entry[status_start - 1] != ' ' || !status_end.has_value() || status_end.value() - status_start != 3) {
+        return false;
+    }
+
+    to.status.assign(raw_entry + status_start, (status_end.value() - status_start));
+
+    if (!BaselineIsNumeric(to.status.c_str())) {
+        return false;
+    }
+
+    size_t bytes_sent_start = status_end.value() + 1;
+
+    if (raw_entry[bytes_sent_start - 1] != ' ') {
+        return false;
+    }
+
+    if (std::strlen(raw_entry + bytes_sent_start) == 1 && raw_entry[bytes_sent_start] == '-') {
+        to.bytes_sent = 0;
+    } else {
+        std::expected<int64_t, const char*> bytes_sent = BaselineParseInt(raw_entry + bytes_sent_start);
+        if (!bytes_sent.has_value()) {
+            return false;
+        }
+
+        to.bytes_sent = bytes_sent.value();
+    }
+
+    return true;
+}
@@ -0,0 +1,248 @@
+#include "baseline.hpp"
+#include "datetime.hpp"
+#include "parsing.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// runs whole time strings and log lines through the parsers of the utility and through the frozen original parsing,
+// including truncated and broken inputs
+
+// text after the local time in a log line, the original parsing read the separators past the end of short strings
+const char* kLineTail = "] \"GET /index.html HTTP/1.0\" 200 1024";
+
+// positions of the numeric fields which ParseInt read in "01/Jul/1995:00:00:01 -0400"
+const size_t kSignedFieldStarts[] = {0, 7, 12, 15, 18, 22, 24};
+
+const char kReplacements[] = {'0', '5', '9', '-', '+', ' ', '/', ':', '"', ']', 'a', 'J', '\x80'};
+
+uint64_t failures_amount = 0;
+uint64_t checks_amount = 0;
+
+// inputs on which the original parsing threw std::out_of_range from substr and the utility crashed,
+// the length check before the separators rejects them now
+uint64_t baseline_crashes_amount = 0;
+
+void PrintEscaped(std::string_view input) {
+    for (char c : input) {
+        if (c >= 0x20 && c < 0x7F) {
+            std::cerr << c;
+        } else {
+            std::cerr << "\\x" << std::hex << static_cast<uint32_t>(static_cast<uint8_t>(c)) << std::dec;
+        }
+    }
+}
+
+void ReportMismatch(const char* parser, std::string_view input, const std::string& expected, const std::string& actual) {
+    // only the first mismatches are printed, the rest are counted
+    if (++failures_amount > 20) {
+        return;
+    }
+
+    std::cerr << parser << " mismatch on \"";
+    PrintEscaped(input);
+    std::cerr << "\": expected " << expected << ", got " << actual << '\n';
+}
+
+std::string ToString(std::optional<uint64_t> value) {
+    return value.has_value() ? std::to_string(value.value()) : "nothing";
+}
+
+// ParseInt accepted a minus sign at the start of every date field, the SWAR parsers reject such times on purpose
+bool HasSignedField(std::string_view local_time) {
+    for (size_t start : kSignedFieldStarts) {
+        if (start < local_time.size() && local_time[start] == '-') {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void CheckLocalTime(std::string_view local_time) {
+    std::string line = std::string(local_time) + kLineTail;
+    std::string_view view(line.data(), local_time.size());
+
+    std::optional<uint64_t> expected;
+
+    try {
+        expected = BaselineLocalTimeStringToTimestamp(view);
+    } catch (const std::out_of_range&) {
+        ++baseline_crashes_amount;
+    }
+
+    if (HasSignedField(view)) {
+        expected = std::nullopt;
+    }
+
+    std::optional<uint64_t> actual = LocalTimeStringToTimestamp(view);
+    ++checks_amount;
+
+    if (expected != actual) {
+        ReportMismatch("LocalTimeStringToTimestamp", view, ToString(expected), ToString(actual));
+    }
+}
+
+std::string DescribeEntry(bool is_parsed, const std::string& remote_addr, const std::string& request, const std::string& status,
+                          uint64_t timestamp, int64_t bytes_sent) {
+    if (!is_parsed) {
+        return "invalid";
+    }
+
+    return "[" + remote_addr + "|" + request + "|" + status + "|" + std::to_string(timestamp) + "|" + std::to_string(bytes_sent) + "]";
+}
+
+// the local time as the original parsing cut it from the line
+std::string_view FindLocalTime(const char* line) {
+    const char* remote_addr_end = std::strstr(line, " - - ");
+    if (remote_addr_end == nullptr) {
+        return {};
+    }
+
+    const char* start = remote_addr_end + std::strlen(" - - ");
+    const char* end = std::strstr(start, "]");
+
+    if (*start != '[' || end == nullptr) {
+        return {};
+    }
+
+    return std::string_view(start + 1, end - start - 1);
+}
+
+void CheckLogLine(const std::string& line) {
+    BaselineLogEntry baseline;
+    bool is_expected_parsed = false;
+
+    try {
+        is_expected_parsed = BaselineParseLogEntry(baseline, line.c_str()) && !HasSignedField(FindLocalTime(line.c_str()));
+    } catch (const std::out_of_range&) {
+        ++baseline_crashes_amount;
+    }
+
+    std::string expected = DescribeEntry(is_expected_parsed, baseline.remote_addr, baseline.request, baseline.status,
+                                         baseline.timestamp, baseline.bytes_sent);
+
+    LogEntry entry;
+    bool is_parsed = ParseLogEntry(entry, line.c_str());
+
+    std::string actual = DescribeEntry(is_parsed, is_parsed ? entry.remote_addr.data : "", is_parsed ? entry.request.data : "",
+                                       is_parsed ? entry.status.data : "", entry.timestamp, entry.bytes_sent);
+
+    FreeLogEntry(entry);
+    ++checks_amount;
+
+    if (expected != actual) {
+        ReportMismatch("ParseLogEntry", line, expected, actual);
+    }
+}
+
+// every prefix, every position replaced by every separator and digit, and the string with an extra character
+template <typename Check>
+void CheckMutations(const std::string& input, Check check) {
+    for (size_t length = 0; length <= input.size(); ++length) {
+        check(input.substr(0, length));
+    }
+
+    for (size_t position = 0; position < input.size(); ++position) {
+        std::string mutated = input;
+
+        for (char replacement : kReplacements) {
+            mutated[position] = replacement;
+            check(mutated);
+        }
+    }
+
+    check(input + "0");
+    check(input + " ");
+}
+
+std::string FormatLocalTime(uint32_t day, uint32_t month, uint32_t year, uint32_t hours, uint32_t minutes, uint32_t seconds,
+                            char sign, uint32_t shift) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%02u/%s/%04u:%02u:%02u:%02u %c%04u", day, kMonthsList[month - 1], year, hours, minutes,
+                  seconds, sign, shift);
+
+    return buffer;
+}
+
+void CheckLocalTimes() {
+    const char* kInputs[] = {
+        "01/Jul/1995:00:00:01 -0400", "01/Jan/1970:00:00:01 +0000", "01/Jan/1970:00:00:00 +0000", "29/Feb/2000:12:30:45 +0530",
+        "29/Feb/1900:00:00:00 +0000", "31/Dec/9999:23:59:59 -1200", "00/Jul/1995:00:00:01 -0400", "32/Jan/1995:00:00:01 -0400",
+        "31/Feb/1995:00:00:01 -0400", "01/Jul/1995:99:99:99 -9999", "01/Jul/0000:00:00:01 -0400", "01/Jul/1969:00:00:01 -0400",
+        "01/jul/1995:00:00:01 -0400", "01/Jul/1995:00:00:01 0400", "1/Jul/1995:00:00:01 -0400", "01/Jul/1995:00:00:01 -04000",
+        "01/Jul/1995 00:00:01 -0400", "", "0", "01/", "01/Jul", "01/Jul/1995", "01/Jul/1995:00:00:01",
+    };
+
+    for (const char* input : kInputs) {
+        CheckMutations(input, CheckLocalTime);
+    }
+
+    // a deterministic spread of valid times over the years which the timestamps can hold
+    uint64_t state = 1;
+
+    for (int32_t i = 0; i < 2000; ++i) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+
+        uint32_t month = (state >> 8) % 12 + 1;
+        uint32_t day = (state >> 16) % 28 + 1;
+        uint32_t year = 1970 + (state >> 24) % 500;
+        uint32_t hours = (state >> 32) % 24;
+        uint32_t minutes = (state >> 40) % 60;
+        uint32_t seconds = (state >> 46) % 60;
+        uint32_t shift = ((state >> 52) % 15) * 100 + ((state >> 56) % 4) * 15;
+
+        std::string local_time = FormatLocalTime(day, month, year, hours, minutes, seconds, (state & 1) ? '+' : '-', shift);
+
+        if (i < 100) {
+            CheckMutations(local_time, CheckLocalTime);
+        } else {
+            CheckLocalTime(local_time);
+        }
+    }
+}
+
+void CheckLogLines() {
+    const char* kLines[] = {
+        "199.72.81.55 - - [01/Jul/1995:00:00:01 -0400] \"GET /history/apollo/ HTTP/1.0\" 200 6245",
+        "unicomp6.unicomp.net - - [01/Jul/1995:00:00:06 -0400] \"GET /shuttle/countdown/ HTTP/1.0\" 503 3985",
+        "burger.letters.com - - [01/Jul/1995:00:00:12 -0400] \"GET /images/NASA-logosmall.gif HTTP/1.0\" 304 0",
+        "d104.aa.net - - [01/Jul/1995:00:00:13 -0400] \"GET /shuttle/countdown/count.gif HTTP/1.0\" 500 -",
+        "a.com - - [01/Jul/1995:00:00:13 -0400] \"GET /api/users/16?x=1 HTTP/1.0\" 200 -5",
+        "a.com - - [01/Jul/1995:00:00:13 -0400] \"GET / HTTP/1.0\" 200 9223372036854775807",
+        "a.com - - [01/Jul/1995:00:00:13 -0400] \"GET / HTTP/1.0\" 200 9223372036854775808",
+        "a.com - - [01/Jul/1995:00:00:13 -0400] \"GET / HTTP/1.0\" 200 ",
+        "a.com - - [01/Jul/1995:00:00:13 -0400] \"GET / HTTP/1.0\" 20 1",
+        "a.com - - [01/Jul/1995:00:00:13 -0400] \"GET / HTTP/1.0\" 2000 1",
+        "a.com - - [01/Jul/1995:00:00:13 -0400] \"\" 200 1",
+        "a.com - - [01/Jul/1995:00:00:13 -0400] \"GET /a\"b HTTP/1.0\" 200 1",
+        "a.com - - [01/Jan/1970:00:00:00 +0000] \"GET / HTTP/1.0\" 200 1",
+        " - - [01/Jul/1995:00:00:13 -0400] \"GET / HTTP/1.0\" 200 1",
+        "a.com - - - - [01/Jul/1995:00:00:13 -0400] \"GET / HTTP/1.0\" 200 1",
+        "a.com - - [-1/Jul/1995:00:00:13 -0400] \"GET / HTTP/1.0\" 200 1",
+        "a.com - - [01/Jul/1995:00:00:13 +-100] \"GET / HTTP/1.0\" 200 1",
+    };
+
+    for (const char* line : kLines) {
+        CheckMutations(line, CheckLogLine);
+    }
+}
+
+int main() {
+    CheckLocalTimes();
+    CheckLogLines();
+
+    if (failures_amount > 0) {
+        std::cerr << failures_amount << " mismatches in " << checks_amount << " checks" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All " << checks_amount << " inputs are parsed as before, " << baseline_crashes_amount
+              << " of them crashed the original parsing and are rejected now" << std::endl;
+    return 0;
+}
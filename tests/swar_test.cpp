@@ -0,0 +1,205 @@
+#include "baseline.hpp"
+#include "swar.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// compares the SWAR parsers with the parsing they replaced, exhaustively where the input space allows
+
+uint64_t failures_amount = 0;
+
+void ReportMismatch(const char* parser, std::string_view input, std::optional<int64_t> expected, std::optional<int64_t> actual) {
+    // only the first mismatches are printed, the rest are counted
+    if (++failures_amount > 20) {
+        return;
+    }
+
+    std::cerr << parser << " mismatch on \"";
+
+    for (char c : input) {
+        if (c >= 0x20 && c < 0x7F) {
+            std::cerr << c;
+        } else {
+            std::cerr << "\\x" << std::hex << static_cast<uint32_t>(static_cast<uint8_t>(c)) << std::dec;
+        }
+    }
+
+    std::cerr << "\": expected " << (expected.has_value() ? std::to_string(expected.value()) : "nothing")
+              << ", got " << (actual.has_value() ? std::to_string(actual.value()) : "nothing") << '\n';
+}
+
+void Expect(const char* parser, std::string_view input, std::optional<int64_t> expected, std::optional<int64_t> actual) {
+    if (expected != actual) {
+        ReportMismatch(parser, input, expected, actual);
+    }
+}
+
+template <typename T>
+std::optional<int64_t> Widen(std::optional<T> value) {
+    return value.has_value() ? std::optional<int64_t>(value.value()) : std::nullopt;
+}
+
+// The date fields were read with ParseInt, which also accepts a minus sign, so a day of "-5" gave a garbage timestamp.
+// The SWAR parsers reject signs on purpose, this is the only expected difference from the original parsing.
+std::optional<int64_t> ParseDateField(std::string_view str) {
+    if (!str.empty() && str[0] == '-') {
+        return std::nullopt;
+    }
+
+    std::expected<int64_t, const char*> result = BaselineParseInt(str);
+    return result.has_value() ? std::optional<int64_t>(result.value()) : std::nullopt;
+}
+
+// the status had to be numeric, a line cannot hold a zero byte, so the three bytes are a C string
+std::optional<int64_t> ParseStatus(std::string_view str) {
+    std::string status(str);
+
+    if (status.find('\0') != std::string::npos || !BaselineIsNumeric(status.c_str())) {
+        return std::nullopt;
+    }
+
+    return BaselineParseInt(status).value();
+}
+
+std::optional<int64_t> ParseTimezoneWithBaseline(std::string_view timezone) {
+    if (timezone[0] != '+' && timezone[0] != '-') {
+        return std::nullopt;
+    }
+
+    std::optional<int64_t> hours = ParseDateField(timezone.substr(1, 2));
+    std::optional<int64_t> minutes = ParseDateField(timezone.substr(3, 2));
+
+    if (!hours.has_value() || !minutes.has_value()) {
+        return std::nullopt;
+    }
+
+    return hours.value() * 60 * 60 + minutes.value() * 60;
+}
+
+void CheckBoundedInt(std::string_view input) {
+    std::expected<int64_t, const char*> expected = BaselineParseInt(input);
+
+    Expect("ParseBoundedInt", input, expected.has_value() ? std::optional<int64_t>(expected.value()) : std::nullopt,
+           ParseBoundedInt(input.data(), input.size()));
+}
+
+void CheckTwoAndThreeBytes() {
+    char input[4] = {};
+
+    for (uint32_t first = 0; first < 256; ++first) {
+        for (uint32_t second = 0; second < 256; ++second) {
+            input[0] = static_cast<char>(first);
+            input[1] = static_cast<char>(second);
+
+            std::string_view two(input, 2);
+            Expect("ParseTwoDigits", two, ParseDateField(two), Widen(ParseTwoDigits(input)));
+            CheckBoundedInt(two);
+
+            for (uint32_t third = 0; third < 256; ++third) {
+                input[2] = static_cast<char>(third);
+
+                std::string_view three(input, 3);
+                Expect("ParseThreeDigits", three, ParseStatus(three), Widen(ParseThreeDigits(input)));
+                CheckBoundedInt(three);
+            }
+        }
+    }
+}
+
+void CheckFourDigits() {
+    char input[5] = {};
+
+    for (uint32_t value = 0; value < 10000; ++value) {
+        std::to_chars(input, input + 4, value + 10000);
+        std::memmove(input, input + 1, 4);
+
+        // every position is also replaced by every other byte
+        for (size_t position = 0; position < 4; ++position) {
+            char digit = input[position];
+
+            for (uint32_t byte = 0; byte < 256; ++byte) {
+                input[position] = static_cast<char>(byte);
+
+                std::string_view four(input, 4);
+                Expect("ParseFourDigits", four, ParseDateField(four), Widen(ParseFourDigits(input)));
+            }
+
+            input[position] = digit;
+        }
+    }
+}
+
+void CheckTimezones() {
+    char input[6] = {};
+
+    for (uint32_t sign = 0; sign < 256; ++sign) {
+        for (uint32_t value = 0; value < 10000; ++value) {
+            input[0] = static_cast<char>(sign);
+            std::to_chars(input + 1, input + 5, value + 10000);
+            std::memmove(input + 1, input + 2, 4);
+
+            std::string_view timezone(input, 5);
+            Expect("ParseTimezoneShift", timezone, ParseTimezoneWithBaseline(timezone), Widen(ParseTimezoneShift(input)));
+        }
+    }
+
+    // broken digits after a valid sign
+    for (size_t position = 1; position < 5; ++position) {
+        for (uint32_t byte = 0; byte < 256; ++byte) {
+            std::memcpy(input, "-0400", 5);
+            input[position] = static_cast<char>(byte);
+
+            std::string_view timezone(input, 5);
+            Expect("ParseTimezoneShift", timezone, ParseTimezoneWithBaseline(timezone), Widen(ParseTimezoneShift(input)));
+        }
+    }
+}
+
+void CheckIntEdgeCases() {
+    const char* kInputs[] = {
+        "", "-", "--1", "+1", " 1", "1 ", "1a", "a1", "0", "-0", "00", "-00", "0000000000000000000000000000001",
+        "-0000000000000000000000000000001", "9223372036854775807", "9223372036854775808", "-9223372036854775808",
+        "-9223372036854775809", "09223372036854775807", "-09223372036854775808", "18446744073709551615",
+        "18446744073709551616", "99999999999999999999", "-99999999999999999999", "1000000000000000000",
+        "9999999999999999999", "-9999999999999999999", "12345678901234567890123",
+    };
+
+    for (const char* input : kInputs) {
+        CheckBoundedInt(input);
+    }
+
+    // every length of all nines and of a one followed by zeros, with and without the sign
+    std::string nines;
+    std::string power = "1";
+
+    for (size_t length = 1; length <= 25; ++length) {
+        nines += '9';
+
+        CheckBoundedInt(nines);
+        CheckBoundedInt('-' + nines);
+        CheckBoundedInt(power);
+        CheckBoundedInt('-' + power);
+
+        power += '0';
+    }
+}
+
+int main() {
+    CheckTwoAndThreeBytes();
+    CheckFourDigits();
+    CheckTimezones();
+    CheckIntEdgeCases();
+
+    if (failures_amount > 0) {
+        std::cerr << failures_amount << " mismatches" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All parsers match" << std::endl;
+    return 0;
+}